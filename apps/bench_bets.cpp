@@ -0,0 +1,50 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "core/thai_poker.hpp"
+
+using namespace thai_poker;
+
+// Per-hand cost of finding every bet a deck satisfies: one satisfied_bets
+// call per hand against the batched overload, on the decks of 12 cards
+// build() feeds it.
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    const int reps = argc > 1 ? std::atoi(argv[1]) : 5;
+    constexpr int HANDS = 1 << 20;
+
+    std::vector<Hand> hands(HANDS);
+    std::mt19937 rng(2137);
+    for (Hand& h : hands) {
+        while (popcount(h) < 12)
+            h |= 1U << (rng() % CARD_NB);
+    }
+
+    std::vector<BetSet> single(HANDS), batched(HANDS);
+    double single_ms = 0, batched_ms = 0;
+    for (int rep = 0; rep < reps; rep++) {
+        single_ms += time_ms([&] {
+            for (int i = 0; i < HANDS; i++)
+                single[i] = satisfied_bets(hands[i]);
+        });
+        batched_ms += time_ms([&] { satisfied_bets(hands, batched); });
+        if (single != batched) {
+            std::fprintf(stderr, "mismatch between evaluators\n");
+            return 1;
+        }
+    }
+
+    std::printf("single:  %8.2f ns / hand\n", single_ms * 1e6 / reps / HANDS);
+    std::printf("batched: %8.2f ns / hand\n", batched_ms * 1e6 / reps / HANDS);
+    std::printf("speedup: %8.2fx\n", single_ms / batched_ms);
+}
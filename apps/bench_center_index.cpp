@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "ai/center_index.hpp"
+#include "logic/hand_table.hpp"
+#include "logic/probability_table.hpp"
+
+using namespace thai_poker;
+
+// Nearest-bucket queries for profiles outside the table: centers are
+// k-means++ seeds over the (hand_size, opp_size) profiles, queries the same
+// hands against opp_size + 1 cards. Brute force over all centers against
+// CenterIndex, exact and with a few probed groups.
+template <typename F>
+double time_us(int queries, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / queries;
+}
+
+std::vector<Profile> profiles(int hand_size, int opp_size, bool unique) {
+    HandTable const& hand_table = HandTable::instance();
+    ProbabilityTable const& prob_table = ProbabilityTable::instance();
+    std::vector<Profile> out;
+    std::map<Profile, int> seen;
+    for (int i = 0; i < HAND_NB; i++) {
+        const Hand hand = hand_table.from_index(i);
+        if (popcount(hand) != hand_size) continue;
+        std::array<int, BET_NB> comp;
+        prob_table.get_comp_vector(hand_size + opp_size, hand, comp);
+        Profile p;
+        std::copy(comp.begin(), comp.end(), p.begin());
+        if (!unique || seen.emplace(p, 0).second)
+            out.push_back(p);
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    const int hand_size = argc > 1 ? std::atoi(argv[1]) : 4;
+    const int opp_size = argc > 2 ? std::atoi(argv[2]) : 8;
+    const int k = argc > 3 ? std::atoi(argv[3]) : 7000;
+    const int query_nb = argc > 4 ? std::atoi(argv[4]) : 2000;
+
+    const std::vector<Profile> points = profiles(hand_size, opp_size, true);
+    CounterRng rng(2137, 0);
+    const std::vector<Profile> centers = kmeans_plus_plus(points, {}, k, rng);
+    std::vector<Profile> queries = profiles(hand_size, opp_size + 1, false);
+    for (std::size_t i = 0; i < queries.size() && static_cast<int>(i) < query_nb; i++)
+        queries[i] = queries[(i * 7919) % queries.size()];
+    queries.resize(std::min<std::size_t>(queries.size(), query_nb));
+    const int n = static_cast<int>(queries.size());
+
+    const CenterBlocks all(centers);
+    const ProfileRows rows(queries);
+    const auto build_start = std::chrono::steady_clock::now();
+    const CenterIndex index(centers);
+    const double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build_start).count();
+
+    std::vector<float> truth(n);
+    double brute_us = time_us(n, [&] {
+        for (int i = 0; i < n; i++) {
+            float second;
+            (void) nearest_center(rows.row(i), all, truth[i], second);
+        }
+    });
+
+    std::printf("%d+%d cards: %zu centers in %d groups (built in %.0f ms), %d queries at %d cards\n",
+                hand_size, opp_size, centers.size(), index.group_nb(), build_ms, n, opp_size + 1);
+    std::printf("brute force      %8.2f us/query\n", brute_us);
+    for (int probes : {0, 1, 2, 4, 8, 16}) {
+        int hits = 0;
+        double us = time_us(n, [&] {
+            for (int i = 0; i < n; i++) {
+                float distance;
+                (void) index.nearest(rows.row(i), distance, probes);
+                hits += distance == truth[i];
+            }
+        });
+        if (probes == 0)
+            std::printf("index, exact     %8.2f us/query  recall %.4f\n", us, double(hits) / n);
+        else
+            std::printf("index, %2d probes %8.2f us/query  recall %.4f\n", probes, us, double(hits) / n);
+    }
+}
@@ -0,0 +1,41 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "core/game.hpp"
+
+using namespace thai_poker;
+
+// Whole games between players who raise by one bet or check at random, to
+// time the engine itself: dealing, legality, showdowns and eliminations.
+int main(int argc, char** argv) {
+    const int games = argc > 1 ? std::atoi(argv[1]) : 1 << 18;
+    const int players = argc > 2 ? std::atoi(argv[2]) : 4;
+
+    std::mt19937_64 rng(2137);
+    long long rounds = 0, bids = 0, sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int g = 0; g < games; g++) {
+        GameState game(players);
+        while (!game.game_over()) {
+            game.deal(rng);
+            while (!game.round_over()) {
+                Bet bet = Bet::HIGH_9;
+                if (game.bid_nb() > 0)
+                    bet = rng() % 4 == 0 ? Bet::CHECK : static_cast<Bet>(to_i(game.last_bid()) + 1);
+                game.play(bet);
+                bids++;
+            }
+            rounds++;
+        }
+        sink += game.winner();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    const double secs = std::chrono::duration<double>(end - start).count();
+    std::printf("%d players: %lld rounds, %lld bids in %.3f s (%.2f M rounds/s)\n",
+                players, rounds, bids, secs, rounds / secs / 1e6);
+    std::printf("(checksum %lld)\n", sink);
+}
@@ -0,0 +1,49 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "logic/hand_table.hpp"
+
+using namespace thai_poker;
+
+// Hand -> index through the 2^24 lookup array against HandTable::rank,
+// and index -> hand through index_to_hand against HandTable::unrank, on
+// random hands so that the lookup array misses cache like it does in
+// get_comp.
+template <typename F>
+double time_ns(int queries, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / queries;
+}
+
+int main(int argc, char** argv) {
+    const int queries = argc > 1 ? std::atoi(argv[1]) : 1 << 24;
+
+    std::vector<int> lookup(1U << CARD_NB, -1);
+    std::vector<Hand> hands(HAND_NB);
+    for (int idx = 0; idx < HAND_NB; idx++) {
+        hands[idx] = HandTable::unrank(idx);
+        lookup[hands[idx]] = idx;
+    }
+
+    std::mt19937 rng(2137);
+    std::vector<int> indices(queries);
+    std::vector<Hand> queried(queries);
+    for (int i = 0; i < queries; i++) {
+        indices[i] = static_cast<int>(rng() % HAND_NB);
+        queried[i] = hands[indices[i]];
+    }
+
+    long long sink = 0;
+    double lookup_ns = time_ns(queries, [&] { for (Hand h : queried) sink += lookup[h]; });
+    double rank_ns = time_ns(queries, [&] { for (Hand h : queried) sink += HandTable::rank(h); });
+    double table_ns = time_ns(queries, [&] { for (int idx : indices) sink += hands[idx]; });
+    double unrank_ns = time_ns(queries, [&] { for (int idx : indices) sink += HandTable::unrank(idx); });
+
+    std::printf("to_index   lookup: %6.2f ns  rank:   %6.2f ns\n", lookup_ns, rank_ns);
+    std::printf("from_index table:  %6.2f ns  unrank: %6.2f ns\n", table_ns, unrank_ns);
+    std::printf("(checksum %lld)\n", sink);
+}
@@ -0,0 +1,62 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ai/l1_kernel.hpp"
+
+using namespace thai_poker;
+
+// Nearest of KMEANS_K-like centers for a batch of points: the scalar double
+// loop build_kmeans used against the float32 block kernel.
+template <typename F>
+double time_ns(long long distances, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / distances;
+}
+
+int main(int argc, char** argv) {
+    const int n = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int k = argc > 2 ? std::atoi(argv[2]) : 7000;
+
+    std::mt19937 rng(2137);
+    auto random_profiles = [&](int count) {
+        std::vector<Profile> v(count);
+        for (auto& p : v) {
+            for (double& x : p)
+                x = static_cast<double>(rng() % 3000000);
+        }
+        return v;
+    };
+    const auto points = random_profiles(n);
+    const auto centers = random_profiles(k);
+    const ProfileRows rows(points);
+    const CenterBlocks blocks(centers);
+
+    long long sink = 0;
+    const long long distances = static_cast<long long>(n) * k;
+    double scalar_ns = time_ns(distances, [&] {
+        for (auto const& p : points) {
+            int best_center = -1;
+            double best = 1e300;
+            for (int c = 0; c < k; c++) {
+                const double d = l1_distance(p, centers[c]);
+                if (best > d) best = d, best_center = c;
+            }
+            sink += best_center;
+        }
+    });
+    double kernel_ns = time_ns(distances, [&] {
+        for (int i = 0; i < n; i++) {
+            float best, second;
+            sink += nearest_center(rows.row(i), blocks, best, second);
+        }
+    });
+
+    std::printf("%d points x %d centers\n", n, k);
+    std::printf("scalar double: %6.2f ns/distance  float32 blocks: %6.2f ns/distance\n", scalar_ns, kernel_ns);
+    std::printf("(checksum %lld)\n", sink);
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ai/cluster_sampler.hpp"
+#include "core/parallel.hpp"
+
+using namespace thai_poker;
+
+// Drawing a (block, hand) pair from a KMEANS_K-block cluster: the uniform
+// int + binary search over block offsets HandCluster::sample_hand used,
+// against ClusterSampler slots with mt19937_64 and with CounterRng. Then
+// disjoint deals from clusters holding every hand: redrawing both hands
+// until disjoint against ClusterSampler::draw_pair. Last, deals per second
+// with one SampleStream per worker filling batches.
+template <typename F>
+double time_ns(long long draws, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / draws;
+}
+
+// every hand of hand_size cards, hand index i in block i % blocks
+ClusterData complete_cluster(int hand_size, int blocks) {
+    std::vector<std::vector<u32>> by_block(blocks);
+    for (int i = 0; i < HAND_NB; i++) {
+        if (popcount(HandTable::unrank(i)) == hand_size)
+            by_block[i % blocks].push_back(static_cast<u32>(i));
+    }
+    ClusterData data;
+    data.offsets.push_back(0);
+    for (auto const& block : by_block) {
+        data.hands.insert(data.hands.end(), block.begin(), block.end());
+        data.offsets.push_back(static_cast<u32>(data.hands.size()));
+    }
+    data.centers.assign(std::size_t(blocks) * BET_NB, 0.0f);
+    return data;
+}
+
+int main(int argc, char** argv) {
+    const long long draws = argc > 1 ? std::atoll(argv[1]) : 20000000;
+    const int blocks = argc > 2 ? std::atoi(argv[2]) : 7000;
+    const int hands = argc > 3 ? std::atoi(argv[3]) : 40000;
+    const unsigned threads = resolve_threads(argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 0);
+
+    // 3-card hands, drawn with repeats, in blocks of random sizes
+    std::mt19937 gen(2137);
+    ClusterData data;
+    data.offsets.push_back(0);
+    for (int b = 1; b < blocks; b++)
+        data.offsets.push_back(static_cast<u32>(gen() % (hands + 1)));
+    data.offsets.push_back(static_cast<u32>(hands));
+    std::sort(data.offsets.begin(), data.offsets.end());
+    std::vector<u32> three;
+    for (int i = 0; i < HAND_NB; i++) {
+        if (popcount(HandTable::unrank(i)) == 3)
+            three.push_back(static_cast<u32>(i));
+    }
+    for (int i = 0; i < hands; i++)
+        data.hands.push_back(three[gen() % three.size()]);
+    data.centers.assign(std::size_t(blocks) * BET_NB, 0.0f);
+
+    ClusterSet clusters;
+    clusters.set(3, 5, std::move(data));
+    ClusterView const& view = clusters.at(3, 5);
+    const ClusterSampler sampler(clusters);
+
+    long long sink = 0;
+    std::mt19937_64 mt(2137);
+    double search_ns = time_ns(draws, [&] {
+        for (long long i = 0; i < draws; i++) {
+            const int which = std::uniform_int_distribution<int>(0, hands - 1)(mt);
+            const int block = static_cast<int>(std::upper_bound(view.offsets.begin() + 1, view.offsets.end(),
+                                                                static_cast<u32>(which))
+                                               - (view.offsets.begin() + 1));
+            sink += block + view.hands[which];
+        }
+    });
+    double slot_mt_ns = time_ns(draws, [&] {
+        for (long long i = 0; i < draws; i++) {
+            ClusterSampler::Slot s = sampler.draw(3, 5, mt);
+            sink += s.block() + s.hand_index();
+        }
+    });
+    CounterRng counter(2137, 0);
+    double slot_counter_ns = time_ns(draws, [&] {
+        for (long long i = 0; i < draws; i++) {
+            ClusterSampler::Slot s = sampler.draw(3, 5, counter);
+            sink += s.block() + s.hand_index();
+        }
+    });
+
+    std::printf("%d blocks, %d hands, %lld draws\n", blocks, hands, draws);
+    std::printf("binary search: %6.2f ns  slots+mt19937_64: %6.2f ns  slots+CounterRng: %6.2f ns\n",
+                search_ns, slot_mt_ns, slot_counter_ns);
+
+    ClusterSet full;
+    const int sizes[][2] = {{3, 5}, {5, 3}, {6, 6}};
+    for (auto [h1, h2] : sizes)
+        full.set(h1, h2, complete_cluster(h1, blocks));
+    const ClusterSampler full_sampler(full);
+    for (auto [h1, h2] : sizes) {
+        double rejection_ns = time_ns(draws / 4, [&] {
+            for (long long i = 0; i < draws / 4; i++) {
+                ClusterSampler::Slot s1, s2;
+                do {
+                    s1 = full_sampler.draw(h1, h2, counter);
+                    s2 = full_sampler.draw(h2, h1, counter);
+                } while (s1.hand() & s2.hand());
+                sink += s1.block() + s2.block();
+            }
+        });
+        double exact_ns = time_ns(draws / 4, [&] {
+            for (long long i = 0; i < draws / 4; i++) {
+                ClusterSampler::Pair p = full_sampler.draw_pair(h1, h2, counter);
+                sink += p.h1.block() + p.h2.block();
+            }
+        });
+        std::printf("%d+%d cards  rejection: %6.2f ns/pair  draw_pair: %6.2f ns/pair\n",
+                    h1, h2, rejection_ns, exact_ns);
+    }
+
+    constexpr int BATCH = 4096;
+    const int batches = static_cast<int>(draws / BATCH);
+    std::vector<long long> worker_sink(threads);
+    double stream_ns = time_ns(static_cast<long long>(batches) * BATCH, [&] {
+        parallel_for(batches, threads, [&](int batch, unsigned worker) {
+            SampleStream deals(full_sampler, 2137, static_cast<std::uint64_t>(batch));
+            std::array<GameSample, BATCH> out;
+            deals.fill(3, 5, out);
+            for (GameSample const& g : out)
+                worker_sink[worker] += g.h1_block + g.h2_block;
+        });
+    });
+    for (long long w : worker_sink)
+        sink += w;
+    std::printf("3+5 cards  %u threads: %.1fM deals/s\n", threads, 1e3 / stream_ns);
+    std::printf("(%lld)\n", sink);
+}
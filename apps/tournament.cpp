@@ -0,0 +1,159 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "core/game.hpp"
+#include "core/parallel.hpp"
+#include "core/random.hpp"
+
+using namespace thai_poker;
+
+// Self-play between pluggable agents on all cores. Game g is played with its
+// own CounterRng stream, so the results depend on the seed only and not on
+// the number of threads.
+//
+//   tournament [games] [seed] [threads] [agent...]
+
+// An agent picks a legal bet for game.to_move() and looks at no hand but
+// its own.
+using Agent = Bet (*)(GameState const&, CounterRng&);
+
+namespace {
+
+Bet raise_by(GameState const& game, int by) {
+    if (game.bid_nb() == 0) return static_cast<Bet>(by - 1);
+    return static_cast<Bet>(std::min(to_i(game.last_bid()) + by, BET_NB - 1));
+}
+
+// Opens low, then checks a third of the time or raises by one to three.
+Bet random_agent(GameState const& game, CounterRng& rng) {
+    if (game.bid_nb() > 0 && (rng() % 3 == 0 || !game.is_legal(raise_by(game, 1))))
+        return Bet::CHECK;
+    return raise_by(game, 1 + static_cast<int>(rng() % 3));
+}
+
+// Bids the best hand it holds, checks anything above it.
+Bet greedy_agent(GameState const& game, CounterRng&) {
+    const Bet best = best_bet(game.hand(game.to_move()));
+    return game.is_legal(best) ? best : Bet::CHECK;
+}
+
+// Raises by one while its own cards back the bid up, checks otherwise.
+Bet cautious_agent(GameState const& game, CounterRng&) {
+    const Hand hand = game.hand(game.to_move());
+    if (game.bid_nb() == 0) return best_bet(hand);
+    const Bet next = raise_by(game, 1);
+    return game.is_legal(next) && satisfies_bet(hand, next) ? next : Bet::CHECK;
+}
+
+struct NamedAgent {
+    const char* name;
+    Agent agent;
+};
+
+constexpr std::array<NamedAgent, 3> AGENTS = {{
+    {"random", random_agent},
+    {"greedy", greedy_agent},
+    {"cautious", cautious_agent},
+}};
+
+const NamedAgent* find_agent(const char* name) {
+    for (auto const& a : AGENTS) {
+        if (std::strcmp(a.name, name) == 0) return &a;
+    }
+    return nullptr;
+}
+
+// seat p of game g is taken by entrant (p + g) % n, so every entrant opens
+// equally often
+int play_game(std::vector<const NamedAgent*> const& entrants, std::uint64_t seed, long long g,
+              long long& rounds) {
+    const int n = static_cast<int>(entrants.size());
+    CounterRng rng(seed, static_cast<std::uint64_t>(g));
+    GameState game(n);
+    while (!game.game_over()) {
+        game.deal(rng);
+        while (!game.round_over()) {
+            const int entrant = static_cast<int>((game.to_move() + g) % n);
+            game.play(entrants[entrant]->agent(game, rng));
+        }
+        rounds++;
+    }
+    return static_cast<int>((game.winner() + g) % n);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const long long games = argc > 1 ? std::atoll(argv[1]) : 1 << 18;
+    const std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2137;
+    const unsigned threads = resolve_threads(argc > 3 ? std::atoi(argv[3]) : 0);
+    if (games <= 0) {
+        std::fprintf(stderr, "games must be positive\n");
+        return 1;
+    }
+
+    std::vector<const NamedAgent*> entrants;
+    for (int i = 4; i < argc; i++) {
+        const NamedAgent* a = find_agent(argv[i]);
+        if (!a) {
+            std::fprintf(stderr, "unknown agent %s (random, greedy, cautious)\n", argv[i]);
+            return 1;
+        }
+        entrants.push_back(a);
+    }
+    if (entrants.empty())
+        entrants = {&AGENTS[0], &AGENTS[1], &AGENTS[2]};
+    const int n = static_cast<int>(entrants.size());
+    if (n < PLAYER_NB_MIN || n > PLAYER_NB_MAX) {
+        std::fprintf(stderr, "%d agents, a game takes %d to %d\n", n, PLAYER_NB_MIN, PLAYER_NB_MAX);
+        return 1;
+    }
+
+    constexpr long long CHUNK = 1024;
+    const int tasks = static_cast<int>((games + CHUNK - 1) / CHUNK);
+    std::vector<std::array<long long, PLAYER_NB_MAX>> wins(threads);
+    std::vector<long long> rounds(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    parallel_for(tasks, threads, [&](int task, unsigned worker) {
+        // counted in locals, the workers' slots share cache lines
+        std::array<long long, PLAYER_NB_MAX> task_wins{};
+        long long task_rounds = 0;
+        const long long last = std::min(games, (task + 1) * CHUNK);
+        for (long long g = task * CHUNK; g < last; g++)
+            task_wins[play_game(entrants, seed, g, task_rounds)]++;
+        for (int e = 0; e < n; e++)
+            wins[worker][e] += task_wins[e];
+        rounds[worker] += task_rounds;
+    });
+    auto end = std::chrono::steady_clock::now();
+
+    long long total_rounds = 0;
+    std::array<long long, PLAYER_NB_MAX> total_wins{};
+    for (unsigned w = 0; w < threads; w++) {
+        total_rounds += rounds[w];
+        for (int e = 0; e < n; e++)
+            total_wins[e] += wins[w][e];
+    }
+
+    const double secs = std::chrono::duration<double>(end - start).count();
+    std::printf("%lld games, %lld rounds, seed %llu, %u threads: %.3f s (%.0f games/s)\n",
+                games, total_rounds, static_cast<unsigned long long>(seed), threads,
+                secs, games / secs);
+
+    // 95% Wilson score interval
+    constexpr double z = 1.96;
+    for (int e = 0; e < n; e++) {
+        const double p = static_cast<double>(total_wins[e]) / games;
+        const double denom = 1 + z * z / games;
+        const double center = (p + z * z / (2 * games)) / denom;
+        const double half = z * std::sqrt(p * (1 - p) / games + z * z / (4.0 * games * games)) / denom;
+        std::printf("  %d %-8s %10lld wins  %6.3f%%  [%6.3f%%, %6.3f%%]\n", e, entrants[e]->name,
+                    total_wins[e], 100 * p, 100 * (center - half), 100 * (center + half));
+    }
+}
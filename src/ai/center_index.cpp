@@ -0,0 +1,146 @@
+#include "center_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace thai_poker {
+
+namespace {
+
+// float distances round, the triangle inequality on them is only good to a
+// few ulps of the summed terms
+constexpr float BOUND_SLACK = 1e-5f;
+
+std::vector<Profile> profiles_of(ClusterView const& cluster) {
+    std::vector<Profile> centers(cluster.block_nb());
+    for (int b = 0; b < cluster.block_nb(); b++) {
+        auto center = cluster.center(b);
+        std::copy(center.begin(), center.end(), centers[b].begin());
+    }
+    return centers;
+}
+
+} // namespace
+
+CenterIndex::CenterIndex(ClusterView const& cluster, int groups, unsigned threads)
+    : CenterIndex(profiles_of(cluster), groups, threads) { }
+
+CenterIndex::CenterIndex(std::span<const Profile> centers, int groups, unsigned threads) {
+    const int n = static_cast<int>(centers.size());
+    if (n == 0) return;
+    if (groups <= 0)
+        groups = static_cast<int>(std::lround(std::sqrt(static_cast<double>(n))));
+    groups = std::clamp(groups, 1, std::min(n, MAX_GROUPS));
+
+    CounterRng rng(2137, static_cast<std::uint64_t>(n));
+    std::vector<Profile> pivots = kmeans_plus_plus(centers, {}, groups, rng, threads);
+    KMeansOptions options;
+    options.max_iter = 10;
+    options.threads = threads;
+    const KMeansResult grouping = kmeans(centers, {}, pivots, options);
+
+    // drop groups left empty, renumbering the others
+    std::vector<int> count(pivots.size(), 0);
+    for (int g : grouping.assignment)
+        count[g]++;
+    std::vector<int> group_of(pivots.size(), -1);
+    std::vector<Profile> kept;
+    for (std::size_t g = 0; g < pivots.size(); g++) {
+        if (count[g] == 0) continue;
+        group_of[g] = static_cast<int>(kept.size());
+        kept.push_back(pivots[g]);
+    }
+    const int kept_nb = static_cast<int>(kept.size());
+
+    begin_.assign(kept_nb + 1, 0);
+    for (int c = 0; c < n; c++)
+        begin_[group_of[grouping.assignment[c]] + 1]++;
+    std::partial_sum(begin_.begin(), begin_.end(), begin_.begin());
+    ids_.resize(n);
+    std::vector<int> fill(begin_.begin(), begin_.end() - 1);
+    for (int c = 0; c < n; c++)
+        ids_[fill[group_of[grouping.assignment[c]]]++] = c;
+
+    const ProfileRows pivot_rows(kept);
+    const ProfileRows center_rows(centers);
+    pivots_.assign(kept);
+    radius_.assign(kept_nb, 0.0f);
+    members_.resize(kept_nb);
+    block_begin_.assign(kept_nb + 1, 0);
+    std::vector<float> to_pivot(n);
+    std::vector<Profile> members;
+    for (int g = 0; g < kept_nb; g++) {
+        int* first = ids_.data() + begin_[g];
+        int* last = ids_.data() + begin_[g + 1];
+        for (int* id = first; id != last; id++)
+            to_pivot[*id] = l1_distance(pivot_rows.row(g), center_rows.row(*id));
+        std::sort(first, last, [&](int a, int b) { return to_pivot[a] < to_pivot[b] || (to_pivot[a] == to_pivot[b] && a < b); });
+        radius_[g] = to_pivot[last[-1]];
+
+        members.clear();
+        for (int* id = first; id != last; id++)
+            members.push_back(centers[*id]);
+        members_[g].assign(members);
+        for (int b = 0; b < members_[g].block_nb(); b++) {
+            const int lo = b * CENTER_BLOCK, hi = std::min<int>(lo + CENTER_BLOCK, members.size()) - 1;
+            ring_lo_.push_back(to_pivot[first[lo]]);
+            ring_hi_.push_back(to_pivot[first[hi]]);
+        }
+        block_begin_[g + 1] = static_cast<int>(ring_lo_.size());
+    }
+}
+
+int CenterIndex::nearest(Profile const& point, float& distance, int probes) const noexcept {
+    float row[PROFILE_LANES] = {};
+    for (int bet = 0; bet < BET_NB; bet++)
+        row[bet] = static_cast<float>(point[bet]);
+    return nearest(row, distance, probes);
+}
+
+int CenterIndex::nearest(const float* point, float& distance, int probes) const noexcept {
+    distance = std::numeric_limits<float>::max();
+    const int groups = group_nb();
+    if (groups == 0) return -1;
+
+    float to_pivot[MAX_GROUPS], bound[MAX_GROUPS];
+    int order[MAX_GROUPS];
+    l1_distances(point, pivots_, to_pivot);
+    for (int g = 0; g < groups; g++)
+        bound[g] = to_pivot[g] - radius_[g] - BOUND_SLACK * (to_pivot[g] + radius_[g]);
+    std::iota(order, order + groups, 0);
+    // probing favours the nearest pivots, the exact search the lowest bounds
+    const float* key = probes > 0 ? to_pivot : bound;
+    std::sort(order, order + groups, [&](int a, int b) { return key[a] < key[b]; });
+
+    int best_id = -1;
+    const int limit = probes > 0 ? std::min(probes, groups) : groups;
+    for (int i = 0; i < limit; i++) {
+        const int g = order[i];
+        if (bound[g] > distance) {
+            if (probes > 0) continue;
+            break;
+        }
+        const float dq = to_pivot[g], slack = BOUND_SLACK * (dq + radius_[g]);
+        CenterBlocks const& members = members_[g];
+        for (int b = 0; b < members.block_nb(); b++) {
+            const int ring = block_begin_[g] + b;
+            if (std::max(dq - ring_hi_[ring], ring_lo_[ring] - dq) - slack > distance) continue;
+            float dist[CENTER_BLOCK];
+            l1_block_distances(point, members.block(b), dist);
+            const int base = begin_[g] + b * CENTER_BLOCK;
+            const int lanes = std::min(CENTER_BLOCK, begin_[g + 1] - base);
+            for (int c = 0; c < lanes; c++) {
+                // the first center on ties, as a scan of all of them would find
+                if (dist[c] < distance || (dist[c] == distance && ids_[base + c] < best_id)) {
+                    distance = dist[c];
+                    best_id = ids_[base + c];
+                }
+            }
+        }
+    }
+    return best_id;
+}
+
+} // namespace thai_poker
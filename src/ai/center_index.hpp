@@ -0,0 +1,56 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "cluster_set.hpp"
+#include "kmeans.hpp"
+#include "l1_kernel.hpp"
+
+namespace thai_poker {
+
+// Nearest of many centers under L1 without comparing with all of them.
+// The centers are grouped by k-means on the centers themselves, and every
+// group keeps its pivot and radius, the largest distance from the pivot to a
+// member. L1 is a metric, so no member of group g is closer to a point q
+// than d(q, pivot_g) - radius_g: groups are scanned by increasing bound
+// and the search stops once the bound passes the best distance found, which
+// keeps it exact. Within a group the members are sorted by distance to the
+// pivot and blocked, and a block whose members all lie at [lo, hi] from it
+// is skipped when |d(q, pivot) - [lo, hi]| passes the best distance too.
+// probes > 0 scans at most that many groups instead, those with the nearest
+// pivots, a faster answer that can miss.
+//
+//   CenterIndex index(hand_cluster.cluster(hand_size, opp_size));
+//   float distance;
+//   int block = index.nearest(row, distance);
+class CenterIndex {
+public:
+    static constexpr int MAX_GROUPS = 1024;
+
+    CenterIndex() = default;
+    // groups == 0 takes about sqrt(centers)
+    explicit CenterIndex(std::span<const Profile> centers, int groups = 0, unsigned threads = 0);
+    explicit CenterIndex(ClusterView const& cluster, int groups = 0, unsigned threads = 0);
+
+    [[nodiscard]] int size() const noexcept { return static_cast<int>(ids_.size()); }
+    [[nodiscard]] int group_nb() const noexcept { return pivots_.size(); }
+
+    // point is a row of PROFILE_LANES floats (see ProfileRows); returns the
+    // index of the nearest center and its distance, -1 without centers
+    [[nodiscard]] int nearest(const float* point, float& distance, int probes = 0) const noexcept;
+    [[nodiscard]] int nearest(Profile const& point, float& distance, int probes = 0) const noexcept;
+
+private:
+    CenterBlocks pivots_;
+    std::vector<float> radius_;
+    std::vector<CenterBlocks> members_;
+    std::vector<int> ids_;   // original index of the members, group by group
+    std::vector<int> begin_; // first member of every group in ids_
+    // distance range from the pivot of the members of every block, blocks
+    // of group g from block_begin_[g]
+    std::vector<float> ring_lo_, ring_hi_;
+    std::vector<int> block_begin_;
+};
+
+} // namespace thai_poker
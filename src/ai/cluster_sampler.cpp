@@ -0,0 +1,60 @@
+#include "cluster_sampler.hpp"
+
+#include <stdexcept>
+
+#include "../logic/subset_sum.hpp"
+
+namespace thai_poker {
+
+ClusterSampler::ClusterSampler(ClusterSet const& clusters) {
+    std::size_t total = 0;
+    for (int c = 0; c < ClusterSet::CLUSTER_NB; c++) {
+        ClusterView const& v = clusters.at(c / (CARD_NB + 1), c % (CARD_NB + 1));
+        if (v.block_nb() > 1 << BLOCK_BITS)
+            throw std::length_error("ClusterSampler: too many blocks");
+        begin_[c] = static_cast<u32>(total);
+        total += v.hands.size();
+    }
+    begin_[ClusterSet::CLUSTER_NB] = static_cast<u32>(total);
+
+    slots_.resize(total);
+    for (int c = 0; c < ClusterSet::CLUSTER_NB; c++) {
+        const int hand_size = c / (CARD_NB + 1), opp_size = c % (CARD_NB + 1);
+        ClusterView const& v = clusters.at(hand_size, opp_size);
+
+        // hands are distinct, so the right count of the right size is all of them
+        bool complete = v.hands.size() == static_cast<std::size_t>(COMB24.get(CARD_NB, hand_size));
+        for (std::size_t i = 0; complete && i < v.hands.size(); i++)
+            complete = popcount(HandTable::unrank(static_cast<int>(v.hands[i]))) == hand_size;
+        complete_[c] = complete;
+
+        Slot* out = slots_.data() + begin_[c];
+        for (int b = 0; b < v.block_nb(); b++) {
+            for (u32 i = v.offsets[b]; i < v.offsets[b + 1]; i++) {
+                const int index = static_cast<int>(v.hands[i]);
+                const Hand hand = HandTable::unrank(index);
+                (complete ? out[colex(hand)] : *out++) = Slot::make(hand, index, b);
+            }
+        }
+    }
+
+    // an h1 draws h2 with probability its share of the disjoint pairs; the
+    // superset sum of the complements of the h2 counts the h2 missing each h1
+    std::vector<int> disjoint;
+    for (int c1 = 0; c1 < ClusterSet::CLUSTER_NB; c1++) {
+        const int c2 = c1 % (CARD_NB + 1) * (CARD_NB + 1) + c1 / (CARD_NB + 1);
+        if (complete_[c2] || begin_[c1] == begin_[c1 + 1] || begin_[c2] == begin_[c2 + 1])
+            continue;
+        disjoint.assign(std::size_t(1) << CARD_NB, 0);
+        for (u32 i = begin_[c2]; i < begin_[c2 + 1]; i++)
+            disjoint[~slots_[i].hand() & ((1u << CARD_NB) - 1)]++;
+        superset_sum(disjoint.data(), CARD_NB);
+
+        std::vector<std::uint64_t>& below = pairs_below_[c1];
+        std::uint64_t total = 0;
+        for (u32 i = begin_[c1]; i < begin_[c1 + 1]; i++)
+            below.push_back(total += static_cast<std::uint64_t>(disjoint[slots_[i].hand()]));
+    }
+}
+
+} // namespace thai_poker
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "../core/random.hpp"
+#include "../logic/combinatorics.hpp"
+#include "../logic/hand_table.hpp"
+#include "cluster_set.hpp"
+
+namespace thai_poker {
+
+struct GameSample {
+    Hand h1; int h1_block;
+    Hand h2; int h2_block;
+};
+
+// Sampling tables over a ClusterSet. Each cluster's hands are uniform, so
+// rather than an alias table over blocks, every slot packs a hand with its
+// index and block: drawing a hand of a cluster together with its block is
+// one random number and one load, where walking the offsets is a binary
+// search.
+//
+//   ClusterSampler sampler(clusters);
+//   CounterRng rng(seed, stream);
+//   ClusterSampler::Slot s = sampler.draw(hand_size, opp_size, rng);
+//   ClusterSampler::Pair p = sampler.draw_pair(h1_size, h2_size, rng);
+class ClusterSampler {
+public:
+    static constexpr int INDEX_BITS = 18;
+    static constexpr int BLOCK_BITS = 16;
+    static_assert(HAND_NB <= 1 << INDEX_BITS);
+    static_assert(CARD_NB + INDEX_BITS + BLOCK_BITS <= 64);
+    // redraws of both hands from clusters missing hands before weighted_pair,
+    // and of h2 there before it scans for one
+    static constexpr int PAIR_TRIES = 64;
+
+    struct Slot {
+        std::uint64_t packed;
+
+        [[nodiscard]] static constexpr Slot make(Hand hand, int hand_index, int block) noexcept {
+            return Slot{hand | static_cast<std::uint64_t>(hand_index) << CARD_NB
+                        | static_cast<std::uint64_t>(block) << (CARD_NB + INDEX_BITS)};
+        }
+
+        [[nodiscard]] Hand hand() const noexcept { return static_cast<Hand>(packed & ((1u << CARD_NB) - 1)); }
+        [[nodiscard]] int hand_index() const noexcept {
+            return static_cast<int>((packed >> CARD_NB) & ((1u << INDEX_BITS) - 1));
+        }
+        [[nodiscard]] int block() const noexcept { return static_cast<int>(packed >> (CARD_NB + INDEX_BITS)); }
+    };
+
+    // h1 from cluster (h1_size, h2_size), h2 from (h2_size, h1_size)
+    struct Pair {
+        Slot h1, h2;
+    };
+
+    ClusterSampler() = default;
+    // copies what it draws from: clusters may change or go away after, the
+    // sampler draws from them as they were until it is rebuilt. Clusters
+    // missing hands cost a 2^CARD_NB superset sum each. Throws
+    // std::length_error if a cluster has more than 2^BLOCK_BITS blocks
+    explicit ClusterSampler(ClusterSet const& clusters);
+
+    // slots of an empty cluster cannot be drawn
+    [[nodiscard]] u32 size(int hand_size, int opp_size) const noexcept {
+        const int c = hand_size * (CARD_NB + 1) + opp_size;
+        return begin_[c + 1] - begin_[c];
+    }
+    // every hand of hand_size cards is in the cluster
+    [[nodiscard]] bool complete(int hand_size, int opp_size) const noexcept {
+        return complete_[hand_size * (CARD_NB + 1) + opp_size];
+    }
+
+    template <std::uniform_random_bit_generator Rng>
+    [[nodiscard]] Slot draw(int hand_size, int opp_size, Rng& rng) const noexcept {
+        const int c = hand_size * (CARD_NB + 1) + opp_size;
+        return slots_[begin_[c] + uniform_below(rng, begin_[c + 1] - begin_[c])];
+    }
+
+    // Two disjoint hands, distributed as drawing both uniformly until they
+    // are disjoint. When the second cluster holds every hand of its size,
+    // the number of h2 disjoint from any h1 is C(CARD_NB - h1_size, h2_size),
+    // so h1 is uniform and h2 is a uniform subset of the cards h1 left: h1 is
+    // drawn once and h2 picked from the cards left, with no rejection. That
+    // cluster's slots are stored in colex order, so h2's is found by rank.
+    // Otherwise this redraws both up to PAIR_TRIES times, then falls back to
+    // weighted_pair: failed redraws leave the distribution of the pair as it
+    // was, so both are exact. Throws std::domain_error if no two hands are
+    // disjoint.
+    template <std::uniform_random_bit_generator Rng>
+    [[nodiscard]] Pair draw_pair(int h1_size, int h2_size, Rng& rng) const;
+
+    // rank of a hand among the hands of as many cards, in colex order
+    [[nodiscard]] static int colex(Hand h) noexcept {
+        int rank = 0;
+        for (int i = 1; h; h &= h - 1, i++)
+            rank += COMB24.get(std::countr_zero(h), i);
+        return rank;
+    }
+
+private:
+    std::array<u32, ClusterSet::CLUSTER_NB + 1> begin_{};
+    std::array<bool, ClusterSet::CLUSTER_NB> complete_{};
+
+    // set bits of every byte
+    static constexpr auto CARDS_IN_BYTE = [] {
+        std::array<std::uint8_t, 256> cards{};
+        for (int bits = 0; bits < 256; bits++)
+            cards[bits] = static_cast<std::uint8_t>(std::popcount(static_cast<unsigned>(bits)));
+        return cards;
+    }();
+    // DEPOSIT[mask][bits]: the low bits of bits moved onto the set bits of
+    // mask, lowest first
+    static constexpr auto DEPOSIT = [] {
+        std::array<std::array<std::uint8_t, 256>, 256> deposit{};
+        for (unsigned mask = 0; mask < 256; mask++) {
+            for (unsigned bits = 0; bits < 256; bits++) {
+                unsigned out = 0, from = bits;
+                for (unsigned m = mask; m; m &= m - 1, from >>= 1)
+                    out |= (from & 1) * (m & -m);
+                deposit[mask][bits] = static_cast<std::uint8_t>(out);
+            }
+        }
+        return deposit;
+    }();
+    // COLEX_OF_BYTE[byte][below][bits]: what the cards bits << 8 * byte add
+    // to colex() of a hand with below cards under them
+    static constexpr auto COLEX_OF_BYTE = [] {
+        std::array<std::array<std::array<int, 256>, HAND_SZ + 1>, CARD_NB / 8> colex{};
+        for (int byte = 0; byte < CARD_NB / 8; byte++) {
+            for (int below = 0; below <= HAND_SZ; below++) {
+                for (unsigned bits = 0; bits < 256; bits++) {
+                    int i = below;
+                    for (unsigned m = bits; m; m &= m - 1)
+                        colex[byte][below][bits] += COMB24.get(8 * byte + std::countr_zero(m), ++i);
+                }
+            }
+        }
+        return colex;
+    }();
+
+    std::vector<Slot> slots_; // by block, or by colex() in complete clusters
+    // by h1 cluster, when the h2 cluster misses hands: running totals over the
+    // h1 slots of the h2 disjoint from them
+    std::array<std::vector<std::uint64_t>, ClusterSet::CLUSTER_NB> pairs_below_;
+
+    // h1 in proportion to its disjoint h2, then h2 uniform among them: the
+    // distribution of redrawing both, in a binary search and a scan at worst
+    template <std::uniform_random_bit_generator Rng>
+    [[nodiscard]] Pair weighted_pair(int h1_size, int h2_size, Rng& rng) const;
+};
+
+// A ClusterSampler with a random stream of its own. Streams share nothing
+// mutable, so every training thread owns one and draws without locking;
+// a (seed, stream) pair replays the same deals on any thread.
+//
+//   parallel_for(tasks, threads, [&](int task, unsigned) {
+//       SampleStream deals(sampler, seed, task);
+//       std::array<GameSample, 1024> batch;
+//       deals.fill(h1_size, h2_size, batch);
+//       ...
+//   });
+class SampleStream {
+public:
+    SampleStream(ClusterSampler const& sampler, std::uint64_t seed, std::uint64_t stream) noexcept
+        : sampler_(&sampler), rng_(seed, stream) { }
+
+    [[nodiscard]] GameSample next(int h1_size, int h2_size) {
+        const ClusterSampler::Pair p = sampler_->draw_pair(h1_size, h2_size, rng_);
+        return GameSample{p.h1.hand(), p.h1.block(), p.h2.hand(), p.h2.block()};
+    }
+
+    // out.size() deals of h1_size against h2_size cards; the deals do not
+    // depend on how a stream's draws are split into batches
+    void fill(int h1_size, int h2_size, std::span<GameSample> out) {
+        for (GameSample& sample : out)
+            sample = next(h1_size, h2_size);
+    }
+
+private:
+    ClusterSampler const* sampler_;
+    CounterRng rng_;
+};
+
+template <std::uniform_random_bit_generator Rng>
+ClusterSampler::Pair ClusterSampler::draw_pair(int h1_size, int h2_size, Rng& rng) const {
+    if (!complete(h2_size, h1_size)) {
+        std::vector<std::uint64_t> const& below = pairs_below_[h1_size * (CARD_NB + 1) + h2_size];
+        if (below.empty() || below.back() == 0)
+            throw std::domain_error("ClusterSampler::draw_pair: no disjoint hands");
+        for (int t = 0; t < PAIR_TRIES; t++) {
+            const Slot s1 = draw(h1_size, h2_size, rng);
+            const Slot s2 = draw(h2_size, h1_size, rng);
+            if ((s1.hand() & s2.hand()) == 0)
+                return Pair{s1, s2};
+        }
+        return weighted_pair(h1_size, h2_size, rng);
+    }
+
+    // The hands of h2_size cards below card m come first in colex order, so
+    // slot r < C(m, h2_size) of the complete cluster is a uniform choice of
+    // h2_size of m cards; spread over the m cards h1 left, it is h2.
+    const Slot s1 = draw(h1_size, h2_size, rng);
+    const int c2 = h2_size * (CARD_NB + 1) + h1_size;
+    const u32 r = uniform_below(rng, static_cast<u32>(COMB24.get(CARD_NB - h1_size, h2_size)));
+    const Hand picks = slots_[begin_[c2] + r].hand();
+    // popcount is a libgcc call without -mpopcnt, a byte's count is a load
+    int rank = 0, below = 0, used = 0;
+    for (int byte = 0; byte < CARD_NB / 8; byte++) {
+        const unsigned free = (~s1.hand() >> (8 * byte)) & 0xFF;
+        const unsigned bits = DEPOSIT[free][(picks >> used) & 0xFF];
+        rank += COLEX_OF_BYTE[byte][below][bits];
+        below += CARDS_IN_BYTE[bits];
+        used += CARDS_IN_BYTE[free];
+    }
+    return Pair{s1, slots_[begin_[c2] + rank]};
+}
+
+template <std::uniform_random_bit_generator Rng>
+ClusterSampler::Pair ClusterSampler::weighted_pair(int h1_size, int h2_size, Rng& rng) const {
+    const int c1 = h1_size * (CARD_NB + 1) + h2_size, c2 = h2_size * (CARD_NB + 1) + h1_size;
+    std::vector<std::uint64_t> const& below = pairs_below_[c1];
+    const std::uint64_t pick = uniform_below_64(rng, below.back());
+    const auto i = static_cast<u32>(std::upper_bound(below.begin(), below.end(), pick) - below.begin());
+    const Slot s1 = slots_[begin_[c1] + i];
+
+    for (int t = 0; t < PAIR_TRIES; t++) {
+        const Slot s2 = draw(h2_size, h1_size, rng);
+        if ((s1.hand() & s2.hand()) == 0)
+            return Pair{s1, s2};
+    }
+    const std::span<const Slot> second(slots_.data() + begin_[c2], begin_[c2 + 1] - begin_[c2]);
+    const u32 count = static_cast<u32>(below[i] - (i ? below[i - 1] : 0));
+    u32 skip = uniform_below(rng, count);
+    for (Slot s2 : second) {
+        if ((s1.hand() & s2.hand()) == 0 && skip-- == 0)
+            return Pair{s1, s2};
+    }
+    throw std::logic_error("ClusterSampler::weighted_pair: disjoint count out of date");
+}
+
+} // namespace thai_poker
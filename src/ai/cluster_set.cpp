@@ -0,0 +1,268 @@
+#include "cluster_set.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "../logic/hand_table.hpp"
+
+namespace thai_poker {
+
+namespace {
+
+ClusterView view_of(ClusterData const& data) {
+    return ClusterView{data.offsets, data.hands, data.centers};
+}
+
+} // namespace
+
+void ClusterSet::own_all() {
+    if (!mapped_.is_open()) return;
+    for (int c = 0; c < CLUSTER_NB; c++) {
+        ClusterView const& v = views_[c];
+        owned_[c] = ClusterData{
+            {v.offsets.begin(), v.offsets.end()},
+            {v.hands.begin(), v.hands.end()},
+            {v.centers.begin(), v.centers.end()}};
+        views_[c] = view_of(owned_[c]);
+    }
+    if (buckets_.data() != owned_buckets_.data()) {
+        owned_buckets_.assign(buckets_.begin(), buckets_.end());
+        buckets_ = owned_buckets_;
+    }
+    mapped_.close();
+}
+
+void ClusterSet::write_buckets(int c, bool erase) {
+    if (owned_buckets_.empty()) {
+        owned_buckets_.assign(BUCKET_NB, NO_BUCKET);
+        buckets_ = owned_buckets_;
+    }
+    ClusterView const& v = views_[c];
+    std::uint16_t* row = owned_buckets_.data() + std::size_t(c % (CARD_NB + 1)) * HAND_NB;
+    for (int b = 0; b < v.block_nb(); b++) {
+        for (u32 i = v.offsets[b]; i < v.offsets[b + 1]; i++)
+            row[v.hands[i]] = erase ? NO_BUCKET : static_cast<std::uint16_t>(b);
+    }
+}
+
+void ClusterSet::set(int hand_size, int opp_size, ClusterData data) {
+    if (hand_size < 0 || hand_size > HAND_SZ || opp_size < 0 || opp_size > CARD_NB)
+        throw std::out_of_range("ClusterSet::set: no such cluster");
+    const u32 block_nb = data.offsets.empty() ? 0 : static_cast<u32>(data.offsets.size() - 1);
+    if ((block_nb == 0 && !data.hands.empty()) || data.centers.size() != std::size_t(block_nb) * BET_NB
+        || (block_nb && (data.offsets.front() != 0 || data.offsets.back() != data.hands.size()))
+        || !std::is_sorted(data.offsets.begin(), data.offsets.end()) || block_nb >= NO_BUCKET)
+        throw std::invalid_argument("ClusterSet::set: inconsistent cluster");
+    HandTable const& hand_table = HandTable::instance();
+    for (u32 hand : data.hands) {
+        if (hand >= HAND_NB || popcount(hand_table.from_index(static_cast<int>(hand))) != hand_size)
+            throw std::invalid_argument("ClusterSet::set: hand of the wrong size");
+    }
+    // the old hands of the cluster index the bucket table below
+    if (mapped_.is_open())
+        validate();
+    own_all();
+    const int c = hand_size * (CARD_NB + 1) + opp_size;
+    write_buckets(c, true);
+    owned_[c] = std::move(data);
+    views_[c] = view_of(owned_[c]);
+    write_buckets(c, false);
+}
+
+bool ClusterSet::load(const std::string& path, bool populate) {
+    MappedFile file;
+    if (!file.open(path, populate, MappedFile::Access::Random))
+        return false;
+    if (file.size() < HEADER_SIZE || std::memcmp(file.data(), "HCL1", 4) != 0)
+        return false;
+
+    u32 header[4];
+    std::memcpy(header, file.data() + 4, sizeof(header));
+    auto [version, hands, cards, bets] = header;
+    if (version < 1 || version > VERSION || hands != HAND_SZ + 1 || cards != CARD_NB + 1 || bets != BET_NB)
+        throw std::runtime_error("ClusterSet::load: version/dim mismatch");
+    const std::size_t buckets_at = HEADER_SIZE + CLUSTER_NB * ENTRY_SIZE;
+    if (file.size() < buckets_at + (version >= 2 ? BUCKETS_SIZE : 0))
+        throw std::runtime_error("ClusterSet::load: truncated " + path);
+
+    std::array<ClusterView, CLUSTER_NB> views;
+    for (int c = 0; c < CLUSTER_NB; c++) {
+        u32 block_nb, hand_nb;
+        std::uint64_t at;
+        const std::byte* entry = file.data() + HEADER_SIZE + c * ENTRY_SIZE;
+        std::memcpy(&block_nb, entry, 4);
+        std::memcpy(&hand_nb, entry + 4, 4);
+        std::memcpy(&at, entry + 8, 8);
+
+        const std::size_t offsets_nb = block_nb ? block_nb + 1 : 0;
+        const std::size_t bytes = (offsets_nb + hand_nb + std::size_t(block_nb) * BET_NB) * 4;
+        if (at % 4 != 0 || at > file.size() || file.size() - at < bytes)
+            throw std::runtime_error("ClusterSet::load: truncated " + path);
+
+        // the payload is 4-byte aligned, PROT_READ pages are only read
+        const auto* p = reinterpret_cast<const u32*>(file.data() + at);
+        views[c].offsets = {p, offsets_nb};
+        views[c].hands = {p + offsets_nb, hand_nb};
+        views[c].centers = {reinterpret_cast<const float*>(p + offsets_nb + hand_nb),
+                            std::size_t(block_nb) * BET_NB};
+        if (block_nb >= NO_BUCKET
+            || (block_nb && (views[c].offsets.front() != 0 || views[c].offsets.back() != hand_nb
+                             || !std::is_sorted(views[c].offsets.begin(), views[c].offsets.end()))))
+            throw std::runtime_error("ClusterSet::load: bad block offsets in " + path);
+        // version 1 writes the bucket table from the hands right below
+        if (version < 2 && !views[c].hands.empty()
+            && *std::max_element(views[c].hands.begin(), views[c].hands.end()) >= HAND_NB)
+            throw std::runtime_error("ClusterSet::load: bad hand index in " + path);
+    }
+
+    std::span<const std::uint16_t> buckets;
+    if (version >= 2)
+        buckets = {reinterpret_cast<const std::uint16_t*>(file.data() + buckets_at), BUCKET_NB};
+
+    mapped_ = std::move(file);
+    views_ = views;
+    for (auto& data : owned_)
+        data = ClusterData{};
+    owned_buckets_.clear();
+    buckets_ = buckets;
+    // version 1 has no bucket table
+    if (version < 2) {
+        for (int c = 0; c < CLUSTER_NB; c++)
+            write_buckets(c, false);
+    }
+    return true;
+}
+
+void ClusterSet::validate() const {
+    HandTable const& hand_table = HandTable::instance();
+    std::vector<std::uint8_t> size_of(HAND_NB);
+    for (int hand_index = 0; hand_index < HAND_NB; hand_index++)
+        size_of[hand_index] = static_cast<std::uint8_t>(popcount(hand_table.from_index(hand_index)));
+    for (int c = 0; c < CLUSTER_NB; c++) {
+        for (u32 hand : views_[c].hands) {
+            if (hand >= HAND_NB || size_of[hand] != c / (CARD_NB + 1))
+                throw std::runtime_error("ClusterSet::validate: bad hand index");
+        }
+    }
+    if (buckets_.empty()) return;
+    // every bucket a block of the cluster of its hand's size
+    for (int opp_size = 0; opp_size <= CARD_NB; opp_size++) {
+        // b + 1 wraps NO_BUCKET to 0, so a valid b has b + 1 <= block_nb
+        std::array<int, HAND_SZ + 1> block_nb;
+        for (int hand_size = 0; hand_size <= HAND_SZ; hand_size++)
+            block_nb[hand_size] = at(hand_size, opp_size).block_nb();
+        const std::uint16_t* row = buckets_.data() + std::size_t(opp_size) * HAND_NB;
+        bool ok = true;
+        for (int hand_index = 0; hand_index < HAND_NB; hand_index++)
+            ok &= static_cast<std::uint16_t>(row[hand_index] + 1) <= block_nb[size_of[hand_index]];
+        if (!ok)
+            throw std::runtime_error("ClusterSet::validate: bad bucket");
+    }
+}
+
+void ClusterSet::save(const std::string& path) const {
+    validate();
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("Cannot open " + path);
+
+    const u32 header[4] = {VERSION, HAND_SZ + 1, CARD_NB + 1, BET_NB};
+    std::fwrite("HCL1", 1, 4, f);
+    std::fwrite(header, sizeof(u32), 4, f);
+
+    std::uint64_t at = HEADER_SIZE + CLUSTER_NB * ENTRY_SIZE + BUCKETS_SIZE;
+    for (ClusterView const& v : views_) {
+        const u32 entry[2] = {static_cast<u32>(v.block_nb()), static_cast<u32>(v.hands.size())};
+        std::fwrite(entry, sizeof(u32), 2, f);
+        std::fwrite(&at, sizeof(at), 1, f);
+        at += (v.offsets.size() + v.hands.size() + v.centers.size()) * 4;
+    }
+    std::vector<std::uint16_t> buckets(BUCKETS_SIZE / sizeof(std::uint16_t), NO_BUCKET);
+    std::copy(buckets_.begin(), buckets_.end(), buckets.begin());
+    std::fwrite(buckets.data(), sizeof(std::uint16_t), buckets.size(), f);
+    for (ClusterView const& v : views_) {
+        std::fwrite(v.offsets.data(), sizeof(u32), v.offsets.size(), f);
+        std::fwrite(v.hands.data(), sizeof(u32), v.hands.size(), f);
+        std::fwrite(v.centers.data(), sizeof(float), v.centers.size(), f);
+    }
+
+    if (std::fclose(f) != 0)
+        throw std::runtime_error("Could not write " + path);
+}
+
+bool ClusterSet::load_hcl0(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    char magic[4];
+    if (std::fread(magic, 1, 4, f) != 4 || std::memcmp(magic, "HCL0", 4) != 0) {
+        std::fclose(f);
+        return false;
+    }
+
+    u32 version=0, hands=0, cards=0;
+    std::fread(&version, 1, 4, f);
+    std::fread(&hands, 1, 4, f);
+    std::fread(&cards, 1, 4, f);
+    if (version != 1 || hands != HAND_SZ+1 || cards != CARD_NB+1) {
+        std::fclose(f);
+        throw std::runtime_error("ClusterSet::load_hcl0: version/dim mismatch");
+    }
+
+    // an HCL0 point: BET_NB doubles, int hand_index, int opp_size
+    constexpr std::size_t POINT_SIZE = BET_NB * sizeof(double) + 2 * sizeof(int);
+    std::vector<std::byte> points;
+    std::array<double, BET_NB> profile;
+    bool ok = true;
+    auto read = [&](void* out, std::size_t bytes) {
+        ok = ok && std::fread(out, 1, bytes, f) == bytes;
+    };
+
+    for (int hand_size = 0; ok && hand_size <= HAND_SZ; hand_size++) {
+        for (int opp_size = 0; ok && opp_size <= CARD_NB; opp_size++) {
+            ClusterData data;
+            u32 n_blocks = 0;
+            read(&n_blocks, 4);
+            if (n_blocks) data.offsets.push_back(0);
+            for (u32 b = 0; ok && b < n_blocks; b++) {
+                u32 n_points = 0;
+                read(&n_points, 4);
+                points.resize(std::size_t(n_points) * POINT_SIZE);
+                read(points.data(), points.size());
+                for (u32 i = 0; ok && i < n_points; i++) {
+                    int hand_index;
+                    std::memcpy(&hand_index, points.data() + i * POINT_SIZE + BET_NB * sizeof(double), sizeof(int));
+                    data.hands.push_back(static_cast<u32>(hand_index));
+                }
+                data.offsets.push_back(static_cast<u32>(data.hands.size()));
+            }
+
+            // prefix sums are the offsets again
+            u32 n_prefix = 0;
+            read(&n_prefix, 4);
+            std::vector<int> prefix(n_prefix);
+            read(prefix.data(), prefix.size() * sizeof(int));
+
+            u32 n_centers = 0;
+            read(&n_centers, 4);
+            ok = ok && n_centers == n_blocks;
+            for (u32 i = 0; ok && i < n_centers; i++) {
+                int unused[2];
+                read(profile.data(), sizeof(profile));
+                read(unused, sizeof(unused));
+                for (double x : profile)
+                    data.centers.push_back(static_cast<float>(x));
+            }
+            if (ok)
+                set(hand_size, opp_size, std::move(data));
+        }
+    }
+
+    std::fclose(f);
+    if (!ok)
+        throw std::runtime_error("ClusterSet::load_hcl0: truncated " + path);
+    return true;
+}
+
+} // namespace thai_poker
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../core/thai_poker.hpp"
+#include "../logic/mapped_file.hpp"
+
+namespace thai_poker {
+
+// One (hand_size, opp_size) cluster: block b holds the hand indices
+// hands[offsets[b], offsets[b+1]) and has its center at
+// centers[b * BET_NB, (b+1) * BET_NB).
+struct ClusterView {
+    std::span<const u32> offsets; // block_nb() + 1 entries, or none
+    std::span<const u32> hands;
+    std::span<const float> centers;
+
+    [[nodiscard]] int block_nb() const noexcept {
+        return offsets.empty() ? 0 : static_cast<int>(offsets.size()) - 1;
+    }
+    [[nodiscard]] int block_size(int b) const noexcept {
+        return static_cast<int>(offsets[b + 1] - offsets[b]);
+    }
+    [[nodiscard]] std::span<const float, BET_NB> center(int b) const noexcept {
+        return std::span<const float, BET_NB>(centers.data() + std::size_t(b) * BET_NB, BET_NB);
+    }
+};
+
+struct ClusterData {
+    std::vector<u32> offsets;
+    std::vector<u32> hands;
+    std::vector<float> centers;
+};
+
+// The clusters of every (hand_size, opp_size), saved as HCL1.bin:
+//
+//   "HCL1", u32 version, u32 HAND_SZ+1, u32 CARD_NB+1, u32 BET_NB
+//   per cluster, hand_size major: u32 block_nb, u32 hand_nb, u64 byte offset
+//   u16 bucket_of[CARD_NB+1][HAND_NB], padded to 4 bytes (since version 2)
+//   per cluster at its offset: offsets, hands, centers
+//
+// Everything is 4-byte aligned little-endian, so load() maps the file and
+// serves the views straight from it. Bet profiles are not stored, they are
+// a get_comp_vector away. Version 1 files load with bucket_of rebuilt.
+class ClusterSet {
+public:
+    static constexpr int VERSION = 2;
+    static constexpr std::uint16_t NO_BUCKET = 0xFFFF;
+    static constexpr int CLUSTER_NB = (HAND_SZ + 1) * (CARD_NB + 1);
+
+    ClusterSet() = default;
+    // views point into owned_ or the mapping, both of which survive a move
+    ClusterSet(const ClusterSet&) = delete;
+    ClusterSet& operator=(const ClusterSet&) = delete;
+    ClusterSet(ClusterSet&&) = default;
+    ClusterSet& operator=(ClusterSet&&) = default;
+
+    [[nodiscard]] ClusterView const& at(int hand_size, int opp_size) const {
+        return views_[hand_size * (CARD_NB + 1) + opp_size];
+    }
+    // the block holding hand_index in cluster (cards of the hand, opp_size),
+    // NO_BUCKET when that cluster does not have the hand
+    [[nodiscard]] int bucket_of(int opp_size, int hand_index) const noexcept {
+        return buckets_.empty() ? NO_BUCKET : buckets_[std::size_t(opp_size) * HAND_NB + hand_index];
+    }
+    // the whole table, opp_size major; set() and load() reallocate or unmap it
+    [[nodiscard]] std::span<const std::uint16_t> buckets() const noexcept { return buckets_; }
+
+    // takes ownership; drops the mapping when it replaces a mapped cluster,
+    // after validate(). throws std::invalid_argument on a malformed cluster or
+    // NO_BUCKET blocks; views and buckets() taken before do not survive it
+    void set(int hand_size, int opp_size, ClusterData data);
+
+    // false if there is no HCL1 file at path, throws when it is malformed:
+    // dimensions, a truncated payload or offsets out of order. It reads the
+    // header and offsets only, the hands and buckets are left to validate()
+    bool load(const std::string& path, bool populate = false);
+    // throws std::runtime_error on hand indices out of range or of the wrong
+    // size, or buckets past their cluster's blocks; reads every page
+    void validate() const;
+    // validate()s first
+    void save(const std::string& path) const;
+    // converter from the HCL0 files of the first HandCluster, which kept
+    // every point's double profile; false if there is no HCL0 file at path
+    bool load_hcl0(const std::string& path);
+
+    [[nodiscard]] bool mapped() const { return mapped_.is_open(); }
+
+private:
+    static constexpr std::size_t HEADER_SIZE = 4 + 4 * sizeof(u32);
+    static constexpr std::size_t ENTRY_SIZE = 2 * sizeof(u32) + sizeof(std::uint64_t);
+    static constexpr std::size_t BUCKET_NB = std::size_t(CARD_NB + 1) * HAND_NB;
+    static constexpr std::size_t BUCKETS_SIZE = (BUCKET_NB * sizeof(std::uint16_t) + 3) / 4 * 4;
+
+    void own_all();
+    // sets the owned bucket_of entries of cluster c's hands to their blocks,
+    // or back to NO_BUCKET
+    void write_buckets(int c, bool erase);
+
+    MappedFile mapped_;
+    std::array<ClusterData, CLUSTER_NB> owned_;
+    std::array<ClusterView, CLUSTER_NB> views_;
+    std::vector<std::uint16_t> owned_buckets_;
+    std::span<const std::uint16_t> buckets_;
+};
+
+} // namespace thai_poker
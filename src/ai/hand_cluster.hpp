@@ -5,59 +5,68 @@
 #include <utility>
 
 #include "../logic/probability_table.hpp"
+#include "../core/random.hpp"
+#include "cluster_sampler.hpp"
+#include "cluster_set.hpp"
+#include "kmeans.hpp"
 
 constexpr int KMEANS_K = 7000;
 constexpr int KMEANS_ITER = 2;
+constexpr int KMEANS_BATCH = 0; // > 0: KMEANS_ITER mini-batches of this size
 
 namespace thai_poker {
 
-struct GameSample {
-    Hand h1; int h1_block;
-    Hand h2; int h2_block;
-};
-
 class HandCluster {
 
-    struct Point {
-        std::array<double, BET_NB> p;
-        int hand_index;
-        int opp_size;
-
-        [[nodiscard]] double distance(Point const&) const;
-    };
-
-    struct Cluster {
-        std::vector<std::vector<Point>> blocks;
-        std::vector<int> blocks_prefix_sum;
-        std::vector<Point> centers;
-    };
-
 public:
-    static constexpr int VERSION = 1;
-
-    HandCluster(const std::string&);
+    HandCluster(const std::string& path, const std::string& hcl0_path = "");
     HandCluster(const HandCluster&) = delete;
     HandCluster& operator=(const HandCluster&) = delete;
 
     static HandCluster& instance();
 
-    void build_kmeans();
-    void build_clusters_ds();
+    // threads == 0 uses every hardware thread; the clusters do not depend on it
+    void build_kmeans(unsigned threads = 0);
 
+    // draws from the cluster's own stream, so callers must not share it
+    // between threads; workers take a stream() each instead
     [[nodiscard]] GameSample sample(int, int);
-
+    [[nodiscard]] SampleStream stream(std::uint64_t stream, std::uint64_t seed = 2137) const {
+        return SampleStream(sampler, seed, stream);
+    }
+
+    [[nodiscard]] ClusterView const& cluster(int hand_size, int opp_size) const {
+        return clusters.at(hand_size, opp_size);
+    }
+    // block of a dealt hand against opp_size cards, one load into the
+    // bucket table saved with the clusters
+    [[nodiscard]] int bucket(int opp_size, Hand hand) const {
+        return clusters.bucket_of(opp_size, hand_table.to_index(hand));
+    }
+    [[nodiscard]] int bucket_of(int opp_size, int hand_index) const noexcept {
+        return clusters.bucket_of(opp_size, hand_index);
+    }
+
+    // HCL1, mapped and used in place; see cluster_set.hpp
     bool load(const std::string& path);
     void save(const std::string& path) const;
+    // reads the HCL0 format of earlier builds
+    bool load_hcl0(const std::string& path);
 
 private:
 
-    [[nodiscard]] std::pair<int, Hand> sample_hand(Cluster const&);
+    // subproblems with at least this many hands get all threads in their
+    // assignment step, smaller ones one thread each
+    static constexpr std::size_t PARALLEL_POINTS = 1 << 15;
+
+    // sample()'s own stream, out of the way of the stream ids handed out
+    static constexpr std::uint64_t OWN_STREAM = ~std::uint64_t{0};
 
-    ProbabilityTable const& prob_table;
     HandTable const& hand_table;
-    std::mt19937_64 rng;
 
-    std::array<std::array<Cluster, CARD_NB+1>, HAND_SZ+1> clusters;
+    ClusterSet clusters;
+    ClusterSampler sampler;
+    SampleStream deals;
 };
 
 } // thai_poker
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include "kmeans.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "../core/parallel.hpp"
+#include "l1_kernel.hpp"
+
+namespace thai_poker {
+
+namespace {
+
+constexpr int CHUNK = 256; // points (or centers) per parallel task
+constexpr double INF = std::numeric_limits<double>::max();
+
+struct Accumulator {
+    std::vector<Profile> sum;
+    std::vector<int> cnt;
+};
+
+// Sculley's mini-batch steps: every batch is assigned to the centers as they
+// were at its start, then each point pulls its center by 1 / (points the
+// center has seen so far). Points are drawn by weight, so each draw counts
+// once.
+void mini_batch(ProfileRows const& rows, std::span<const Profile> points,
+                std::span<const int> weights, std::vector<Profile>& centers,
+                KMeansOptions const& options, long long& distances) {
+    const int n = static_cast<int>(points.size());
+    const int k = static_cast<int>(centers.size());
+    const int b = options.batch;
+    const unsigned threads = resolve_threads(options.threads);
+
+    std::vector<long long> prefix(n);
+    long long total = 0;
+    for (int i = 0; i < n; i++)
+        prefix[i] = total += weights.empty() ? 1 : weights[i];
+
+    CounterRng rng(options.seed, 0);
+    std::vector<int> batch(b), batch_center(b);
+    std::vector<long long> seen(k, 0);
+    CenterBlocks blocks;
+    for (int iter = 0; iter < options.max_iter; iter++) {
+        blocks.assign(centers);
+        for (int& i : batch) {
+            const long long r = static_cast<long long>(rng() % static_cast<std::uint64_t>(total));
+            i = static_cast<int>(std::upper_bound(prefix.begin(), prefix.end(), r) - prefix.begin());
+        }
+        parallel_for((b + CHUNK - 1) / CHUNK, threads, [&](int task, unsigned) {
+            const int last = std::min(b, (task + 1) * CHUNK);
+            for (int j = task * CHUNK; j < last; j++) {
+                float error, second;
+                batch_center[j] = nearest_center(rows.row(batch[j]), blocks, error, second);
+            }
+        });
+        distances += static_cast<long long>(b) * k;
+
+        for (int j = 0; j < b; j++) {
+            Profile& center = centers[batch_center[j]];
+            const double eta = 1.0 / ++seen[batch_center[j]];
+            for (int bet = 0; bet < BET_NB; bet++)
+                center[bet] += eta * (points[batch[j]][bet] - center[bet]);
+        }
+    }
+}
+
+} // namespace
+
+std::vector<Profile> kmeans_plus_plus(std::span<const Profile> points, std::span<const int> weights,
+                                      int k, CounterRng& rng, unsigned threads) {
+    const int n = static_cast<int>(points.size());
+    const int tasks = (n + CHUNK - 1) / CHUNK;
+    threads = resolve_threads(threads);
+    auto weight = [&](int i) -> double { return weights.empty() ? 1 : weights[i]; };
+
+    std::vector<Profile> centers;
+    if (n == 0 || k <= 0)
+        return centers;
+
+    // draws a point with probability score(i) / sum of scores, task sums
+    // give the chunk to look in
+    std::vector<double> score(n), task_sum(tasks);
+    auto draw = [&] {
+        double total = 0;
+        for (double t : task_sum)
+            total += t;
+        if (total <= 0)
+            return -1;
+        double r = std::uniform_real_distribution<double>(0, total)(rng);
+        // rounding may run past the end, which then picks the last candidate
+        int task = -1;
+        for (int t = 0; t < tasks; t++) {
+            if (task_sum[t] > 0) {
+                task = t;
+                if (r < task_sum[t]) break;
+                r -= task_sum[t];
+            }
+        }
+        int pick = -1;
+        const int last = std::min(n, (task + 1) * CHUNK);
+        for (int i = task * CHUNK; i < last; i++) {
+            if (score[i] > 0) {
+                pick = i;
+                if (r < score[i]) break;
+                r -= score[i];
+            }
+        }
+        return pick;
+    };
+
+    for (int task = 0; task < tasks; task++) {
+        const int last = std::min(n, (task + 1) * CHUNK);
+        task_sum[task] = 0;
+        for (int i = task * CHUNK; i < last; i++)
+            task_sum[task] += score[i] = weight(i);
+    }
+
+    const ProfileRows rows(points);
+    std::vector<double> nearest_dist(n, INF);
+    for (int chosen = draw(); chosen >= 0; chosen = draw()) {
+        centers.push_back(points[chosen]);
+        if (static_cast<int>(centers.size()) == k)
+            break;
+        const float* center = rows.row(chosen);
+        parallel_for(tasks, threads, [&](int task, unsigned) {
+            const int last = std::min(n, (task + 1) * CHUNK);
+            double sum = 0;
+            for (int i = task * CHUNK; i < last; i++) {
+                nearest_dist[i] = std::min<double>(nearest_dist[i], l1_distance(rows.row(i), center));
+                sum += score[i] = weight(i) * nearest_dist[i] * nearest_dist[i];
+            }
+            task_sum[task] = sum;
+        });
+    }
+    return centers;
+}
+
+double l1_distance(Profile const& a, Profile const& b) noexcept {
+    double dist = 0;
+    for (int bet = 0; bet < BET_NB; bet++)
+        dist += std::abs(a[bet] - b[bet]);
+    return dist;
+}
+
+KMeansResult kmeans(std::span<const Profile> points, std::span<const int> weights,
+                    std::vector<Profile>& centers, KMeansOptions const& options) {
+    const int n = static_cast<int>(points.size());
+    const int k = static_cast<int>(centers.size());
+    const int tasks = (n + CHUNK - 1) / CHUNK;
+    const unsigned threads = resolve_threads(options.threads);
+    const bool accelerated = options.accelerated;
+
+    KMeansResult result;
+    result.assignment.assign(n, -1);
+    auto weight = [&](int i) { return weights.empty() ? 1 : weights[i]; };
+    const ProfileRows rows(points);
+    ProfileRows center_rows(centers);
+    CenterBlocks blocks(centers);
+    std::vector<Accumulator> acc(threads);
+    std::vector<double> task_error(tasks); // summed in task order
+    std::vector<long long> task_distances(tasks);
+    std::vector<int> task_changed(tasks);
+
+    // Hamerly's bounds, valid once every point has been scanned
+    bool bounded = false;
+    std::vector<double> lower(accelerated ? n : 0);
+    std::vector<double> half_gap(accelerated ? k : 0);
+    int moved_most = -1;
+    double moved_max = 0, moved_second = 0;
+    long long gap_distances = 0;
+
+    auto update_half_gap = [&] {
+        const int center_tasks = (k + CHUNK - 1) / CHUNK;
+        parallel_for(center_tasks, threads, [&](int task, unsigned) {
+            const int last = std::min(k, (task + 1) * CHUNK);
+            for (int c = task * CHUNK; c < last; c++) {
+                float gap, second;
+                nearest_center(center_rows.row(c), blocks, gap, second, c);
+                half_gap[c] = gap / 2.0;
+            }
+        });
+        gap_distances += static_cast<long long>(k) * (k - 1);
+    };
+
+    // assigns every point, accumulating per worker when update is set
+    auto assign = [&](bool update) {
+        if (update) {
+            for (auto& a : acc) {
+                a.sum.assign(k, Profile{});
+                a.cnt.assign(k, 0);
+            }
+        }
+        if (accelerated && bounded)
+            update_half_gap();
+
+        parallel_for(tasks, threads, [&](int task, unsigned worker) {
+            Accumulator& a = acc[worker];
+            const int last = std::min(n, (task + 1) * CHUNK);
+            double error_sum = 0;
+            long long distances = 0;
+            int changed = 0;
+            for (int i = task * CHUNK; i < last; i++) {
+                const int previous = result.assignment[i];
+                int center = previous;
+                float error, second;
+                if (!accelerated || !bounded) {
+                    center = nearest_center(rows.row(i), blocks, error, second);
+                    distances += k;
+                    if (accelerated) lower[i] = second;
+                }
+                else {
+                    lower[i] -= center == moved_most ? moved_second : moved_max;
+                    error = l1_distance(rows.row(i), center_rows.row(center));
+                    distances++;
+                    if (error > std::max(half_gap[center], lower[i])) {
+                        center = nearest_center(rows.row(i), blocks, error, second);
+                        distances += k;
+                        lower[i] = second;
+                    }
+                }
+                const int w = weight(i);
+                changed += center != previous;
+                result.assignment[i] = center;
+                error_sum += w * static_cast<double>(error);
+                if (update) {
+                    a.cnt[center] += w;
+                    for (int bet = 0; bet < BET_NB; bet++)
+                        a.sum[center][bet] += w * points[i][bet];
+                }
+            }
+            task_error[task] = error_sum;
+            task_distances[task] = distances;
+            task_changed[task] = changed;
+        });
+        bounded = true;
+
+        double error = 0;
+        for (int task = 0; task < tasks; task++) {
+            error += task_error[task];
+            result.distances += task_distances[task];
+        }
+        return error;
+    };
+
+    if (options.batch > 0) {
+        mini_batch(rows, points, weights, centers, options, result.distances);
+        center_rows.assign(centers);
+        blocks.assign(centers);
+        result.iterations = options.max_iter;
+        result.error = assign(false);
+        result.distances += gap_distances;
+        return result;
+    }
+
+    for (int iter = 0; iter < options.max_iter; iter++) {
+        const double cum_error = assign(true);
+        result.iterations++;
+
+        int changed = 0;
+        for (int c : task_changed)
+            changed += c;
+        if (changed == 0) {
+            result.converged = true;
+            break;
+        }
+
+        moved_most = -1;
+        moved_max = moved_second = 0;
+        for (int center = 0; center < k; center++) {
+            int cnt = 0;
+            Profile sum{};
+            for (auto const& a : acc) {
+                cnt += a.cnt[center];
+                for (int bet = 0; bet < BET_NB; bet++)
+                    sum[bet] += a.sum[center][bet];
+            }
+            if (cnt == 0)
+                continue;
+            Profile const old = centers[center];
+            for (int bet = 0; bet < BET_NB; bet++)
+                centers[center][bet] = sum[bet] / cnt;
+            center_rows.set(center, centers[center]);
+            blocks.set(center, centers[center]);
+
+            // how far the bounds of the other centers' points may drop
+            if (accelerated) {
+                const double moved = l1_distance(old, centers[center]);
+                if (moved > moved_max) {
+                    moved_second = moved_max;
+                    moved_max = moved;
+                    moved_most = center;
+                }
+                else if (moved > moved_second) {
+                    moved_second = moved;
+                }
+            }
+        }
+        if (accelerated)
+            result.distances += k;
+
+        if (cum_error < 1e-7)
+            break;
+    }
+
+    result.error = assign(false);
+    result.distances += gap_distances;
+    return result;
+}
+
+} // namespace thai_poker
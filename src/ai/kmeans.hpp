@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "../core/random.hpp"
+#include "../core/thai_poker.hpp"
+
+namespace thai_poker {
+
+using Profile = std::array<double, BET_NB>; // a hand's bet profile
+
+[[nodiscard]] double l1_distance(Profile const& a, Profile const& b) noexcept;
+
+struct KMeansOptions {
+    int max_iter = 2;
+    unsigned threads = 0; // 0 uses every hardware thread
+    // Hamerly's bounds: skip points whose nearest center provably did not
+    // change. Same centers as plain Lloyd up to rounding in near ties.
+    bool accelerated = true;
+    // Mini-batch k-means (Sculley): each of max_iter steps moves the centers
+    // towards batch points drawn by weight, instead of a full Lloyd step.
+    // 0 runs full Lloyd steps.
+    int batch = 0;
+    std::uint64_t seed = 0; // stream of the mini-batch draws
+};
+
+struct KMeansResult {
+    std::vector<int> assignment; // nearest final center of every point
+    double error = 0;            // weighted sum of the distances to them
+    int iterations = 0;          // Lloyd steps (or batches) run
+    bool converged = false;      // a Lloyd step moved no point
+    long long distances = 0;     // distances computed, centers included
+};
+
+// Lloyd's k-means under the L1 distance: refines centers in place for up to
+// max_iter steps, stopping early once no point changes center, then assigns
+// every point to its nearest center. A center left without points stays
+// where it is. Point i counts weights[i] times (once each when weights is
+// empty), the same as clustering that many copies of it.
+//
+// The assignment step is split over threads in fixed chunks of points, each
+// worker summing its points into its own center accumulators. Points and
+// weights are integers, so those sums are exact, and the error is summed
+// per chunk in chunk order: the result does not depend on the number of
+// threads.
+//
+// Distances are taken in float32 by the kernels of l1_kernel.hpp, sums and
+// centers stay in double.
+//
+// L1 is a metric, so with options.accelerated every point keeps a lower
+// bound on its distance to any center but its own, lowered by how far the
+// centers moved. Each step takes the exact distance to its own center and
+// compares the point with all centers only when that distance exceeds both
+// the lower bound and half the distance from its center to the nearest
+// other one. The bounds take O(points) memory, unlike Elkan's
+// O(points * centers), which does not fit for 7000 centers.
+KMeansResult kmeans(std::span<const Profile> points, std::span<const int> weights,
+                    std::vector<Profile>& centers, KMeansOptions const& options);
+
+// k-means++ seeding: the first center is a point drawn by weight, each next
+// one a point drawn by weight * D^2, D the L1 distance to the nearest center
+// so far. Returns fewer than k centers only when fewer distinct points
+// exist. Each draw is one parallel pass over the points, summed per chunk in
+// chunk order, so the result depends on rng only.
+[[nodiscard]] std::vector<Profile> kmeans_plus_plus(std::span<const Profile> points,
+                                                    std::span<const int> weights, int k,
+                                                    CounterRng& rng, unsigned threads = 0);
+
+} // namespace thai_poker
@@ -0,0 +1,108 @@
+#include "l1_kernel.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "../core/simd.hpp"
+
+namespace thai_poker {
+
+namespace {
+
+// one lane per center of a block; GCC splits it into whatever vectors the
+// clone's instruction set has
+using Lanes = float __attribute__((vector_size(CENTER_BLOCK * sizeof(float))));
+
+// distances from point to the CENTER_BLOCK centers of one block
+[[gnu::always_inline]] inline void block_distances(const float* point, const float* block,
+                                                   float* out) noexcept {
+    Lanes acc = {};
+    for (int bet = 0; bet < BET_NB; bet++) {
+        Lanes lane;
+        std::memcpy(&lane, block + bet * CENTER_BLOCK, sizeof(lane));
+        const Lanes d = lane - point[bet];
+        acc += d < 0 ? -d : d;
+    }
+    std::memcpy(out, &acc, sizeof(acc));
+}
+
+} // namespace
+
+void ProfileRows::assign(std::span<const Profile> profiles) {
+    n_ = static_cast<int>(profiles.size());
+    data_.assign(std::size_t(n_) * PROFILE_LANES, 0.0f);
+    for (int i = 0; i < n_; i++)
+        set(i, profiles[i]);
+}
+
+void ProfileRows::set(int i, Profile const& p) {
+    float* row = data_.data() + std::size_t(i) * PROFILE_LANES;
+    for (int bet = 0; bet < BET_NB; bet++)
+        row[bet] = static_cast<float>(p[bet]);
+}
+
+void CenterBlocks::assign(std::span<const Profile> centers) {
+    k_ = static_cast<int>(centers.size());
+    data_.assign(std::size_t(block_nb()) * BET_NB * CENTER_BLOCK, 0.0f);
+    for (int c = 0; c < k_; c++)
+        set(c, centers[c]);
+}
+
+void CenterBlocks::set(int c, Profile const& p) {
+    float* block = data_.data() + std::size_t(c / CENTER_BLOCK) * BET_NB * CENTER_BLOCK;
+    for (int bet = 0; bet < BET_NB; bet++)
+        block[bet * CENTER_BLOCK + c % CENTER_BLOCK] = static_cast<float>(p[bet]);
+}
+
+THAI_SIMD_CLONES
+float l1_distance(const float* a, const float* b) noexcept {
+    float dist = 0;
+    for (int bet = 0; bet < PROFILE_LANES; bet++)
+        dist += std::fabs(a[bet] - b[bet]);
+    return dist;
+}
+
+THAI_SIMD_CLONES
+void l1_distances(const float* point, CenterBlocks const& centers, float* out) noexcept {
+    const int k = centers.size();
+    float dist[CENTER_BLOCK];
+    for (int b = 0; b < centers.block_nb(); b++) {
+        block_distances(point, centers.block(b), dist);
+        const int base = b * CENTER_BLOCK;
+        for (int c = 0; c < CENTER_BLOCK && base + c < k; c++)
+            out[base + c] = dist[c];
+    }
+}
+
+THAI_SIMD_CLONES
+void l1_block_distances(const float* point, const float* block, float* out) noexcept {
+    block_distances(point, block, out);
+}
+
+THAI_SIMD_CLONES
+int nearest_center(const float* point, CenterBlocks const& centers,
+                   float& best, float& second, int skip) noexcept {
+    const int k = centers.size();
+    int best_center = -1;
+    best = second = std::numeric_limits<float>::max();
+    float dist[CENTER_BLOCK];
+    for (int b = 0; b < centers.block_nb(); b++) {
+        block_distances(point, centers.block(b), dist);
+        const int base = b * CENTER_BLOCK;
+        for (int c = 0; c < CENTER_BLOCK && base + c < k; c++) {
+            if (base + c == skip) continue;
+            if (best > dist[c]) {
+                second = best;
+                best = dist[c];
+                best_center = base + c;
+            }
+            else if (second > dist[c]) {
+                second = dist[c];
+            }
+        }
+    }
+    return best_center;
+}
+
+} // namespace thai_poker
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "kmeans.hpp"
+
+namespace thai_poker {
+
+constexpr int PROFILE_LANES = 72; // BET_NB floats padded to whole AVX2 vectors
+constexpr int CENTER_BLOCK = 16;  // centers per transposed block, one AVX-512 vector
+
+// Profiles as float rows of PROFILE_LANES with zero padding. Counts stay
+// below 2^24, so a float holds them exactly; only the distances round.
+class ProfileRows {
+public:
+    ProfileRows() = default;
+    explicit ProfileRows(std::span<const Profile> profiles) { assign(profiles); }
+
+    void assign(std::span<const Profile> profiles);
+    void set(int i, Profile const& p);
+
+    [[nodiscard]] int size() const noexcept { return n_; }
+    [[nodiscard]] const float* row(int i) const noexcept { return data_.data() + std::size_t(i) * PROFILE_LANES; }
+
+private:
+    std::vector<float> data_;
+    int n_ = 0;
+};
+
+// Centers transposed in blocks of CENTER_BLOCK, bet j of center c at
+// block(c / CENTER_BLOCK)[j * CENTER_BLOCK + c % CENTER_BLOCK], so one point
+// is compared with a whole block in a vector per bet.
+class CenterBlocks {
+public:
+    CenterBlocks() = default;
+    explicit CenterBlocks(std::span<const Profile> centers) { assign(centers); }
+
+    void assign(std::span<const Profile> centers);
+    void set(int c, Profile const& p);
+
+    [[nodiscard]] int size() const noexcept { return k_; }
+    [[nodiscard]] int block_nb() const noexcept { return (k_ + CENTER_BLOCK - 1) / CENTER_BLOCK; }
+    [[nodiscard]] const float* block(int b) const noexcept { return data_.data() + std::size_t(b) * BET_NB * CENTER_BLOCK; }
+
+private:
+    std::vector<float> data_;
+    int k_ = 0;
+};
+
+// The kernels are compiled per instruction set and dispatched at load time
+// (see core/simd.hpp), with a portable build elsewhere.
+
+// L1 distance between two rows
+[[nodiscard]] float l1_distance(const float* a, const float* b) noexcept;
+
+// out[c] = distance from point to center c, for every center
+void l1_distances(const float* point, CenterBlocks const& centers, float* out) noexcept;
+
+// out[i] = distance from point to lane i of one block, CENTER_BLOCK lanes;
+// lanes past the last center of a partial block compare with zeros
+void l1_block_distances(const float* point, const float* block, float* out) noexcept;
+
+// Nearest center to point (the first on ties), its distance and the distance
+// to the second nearest (max float with a single center). Centers in skip
+// are left out, -1 skips none.
+int nearest_center(const float* point, CenterBlocks const& centers,
+                   float& best, float& second, int skip = -1) noexcept;
+
+} // namespace thai_poker
@@ -0,0 +1,78 @@
+#include "game.hpp"
+
+#include <stdexcept>
+
+namespace thai_poker {
+
+GameState::GameState(int players, int starter) {
+    if (players < PLAYER_NB_MIN || players > PLAYER_NB_MAX)
+        throw std::out_of_range("GameState: players");
+    if (starter < 0 || starter >= players)
+        throw std::out_of_range("GameState: starter");
+
+    player_nb_ = static_cast<std::uint8_t>(players);
+    alive_nb_ = player_nb_;
+    starter_ = static_cast<std::uint8_t>(starter);
+    to_move_ = starter_;
+    for (int p = 0; p < players; p++)
+        cards_[p] = static_cast<std::uint8_t>(initial_cards(players));
+}
+
+void GameState::deal(std::span<const Card, CARD_NB> deck) {
+    if (game_over())
+        throw std::logic_error("GameState::deal: game is over");
+
+    int next = 0;
+    table_ = 0;
+    for (int p = 0; p < player_nb_; p++) {
+        Hand h = 0;
+        for (int i = 0; i < cards_[p]; i++)
+            h |= 1U << deck[next++];
+        hands_[p] = h;
+        table_ |= h;
+    }
+    if (popcount(table_) != next)
+        throw std::invalid_argument("GameState::deal: repeated card");
+
+    to_move_ = starter_;
+    bid_nb_ = 0;
+    round_over_ = false;
+}
+
+void GameState::play(Bet b) {
+    if (!is_legal(b))
+        throw std::invalid_argument("GameState::play: illegal bet");
+
+    if (b != Bet::CHECK) {
+        bids_[bid_nb_++] = static_cast<std::uint8_t>(b);
+        bidder_ = to_move_;
+        to_move_ = static_cast<std::uint8_t>(next_alive(to_move_));
+        return;
+    }
+
+    const int loser = satisfies_bet(table_, last_bid()) ? to_move_ : bidder_;
+    loser_ = static_cast<std::int8_t>(loser);
+    round_over_ = true;
+
+    // the limit is taken while the loser is still in the game
+    if (cards_[loser] + 1 > max_cards()) {
+        cards_[loser] = 0;
+        alive_nb_--;
+        starter_ = static_cast<std::uint8_t>(next_alive(loser));
+    }
+    else {
+        cards_[loser]++;
+        starter_ = static_cast<std::uint8_t>(loser);
+    }
+    to_move_ = starter_;
+}
+
+int GameState::winner() const noexcept {
+    if (!game_over()) return -1;
+    for (int p = 0; p < player_nb_; p++) {
+        if (cards_[p]) return p;
+    }
+    return -1;
+}
+
+} // namespace thai_poker
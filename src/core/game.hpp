@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "thai_poker.hpp"
+
+namespace thai_poker {
+
+constexpr int PLAYER_NB_MIN = 2;
+constexpr int PLAYER_NB_MAX = 10;
+
+// Table 1 of the rules
+[[nodiscard]] constexpr int initial_cards(int players) noexcept {
+    return players == 2 ? 3 : players <= 4 ? 2 : 1;
+}
+// Table 2 of the rules, players counts those still in the game
+[[nodiscard]] constexpr int max_cards(int players) noexcept {
+    return std::min(HAND_SZ, 23 / players);
+}
+
+// A whole game of 2..10 players in a fixed-size, trivially copyable value:
+// copying it is a memcpy, so searches can branch on copies and simulations
+// never allocate.
+//
+//   GameState game(players, starter);
+//   while (!game.game_over()) {
+//       game.deal(rng);
+//       while (!game.round_over())
+//           game.play(policy(game));
+//   }
+//
+// Bids only go up, so a round has at most BET_NB of them; bid i was made by
+// the i-th player in turn order from the round's starter.
+class GameState {
+public:
+    GameState() = default;
+    GameState(int players, int starter = 0);
+
+    // Deals the next round from the first cards of deck.
+    void deal(std::span<const Card, CARD_NB> deck);
+    template <std::uniform_random_bit_generator Rng>
+    void deal(Rng& rng);
+
+    // CHECK needs a bid to check, any other bet has to beat the last one.
+    [[nodiscard]] bool is_legal(Bet b) const noexcept {
+        if (round_over_) return false;
+        if (b == Bet::CHECK) return bid_nb_ > 0;
+        return bid_nb_ == 0 || b > last_bid();
+    }
+    // Bids b for the player to move. CHECK ends the round: the checker loses
+    // if the last bid can be formed from all hands, its bidder otherwise.
+    void play(Bet b);
+
+    [[nodiscard]] int player_nb() const noexcept { return player_nb_; }
+    [[nodiscard]] int alive_nb() const noexcept { return alive_nb_; }
+    [[nodiscard]] bool alive(int p) const noexcept { return cards_[p] != 0; }
+    [[nodiscard]] int cards(int p) const noexcept { return cards_[p]; }
+    [[nodiscard]] Hand hand(int p) const noexcept { return hands_[p]; }
+    [[nodiscard]] Hand table() const noexcept { return table_; }
+    [[nodiscard]] int max_cards() const noexcept { return thai_poker::max_cards(alive_nb_); }
+
+    [[nodiscard]] int starter() const noexcept { return starter_; }
+    [[nodiscard]] int to_move() const noexcept { return to_move_; }
+    [[nodiscard]] int bid_nb() const noexcept { return bid_nb_; }
+    [[nodiscard]] Bet bid(int i) const noexcept { return static_cast<Bet>(bids_[i]); }
+    [[nodiscard]] Bet last_bid() const noexcept { return bid_nb_ ? bid(bid_nb_ - 1) : Bet::CHECK; }
+
+    // loser of the last finished round, -1 before the first one; winner is
+    // -1 while the game is on
+    [[nodiscard]] bool round_over() const noexcept { return round_over_; }
+    [[nodiscard]] int loser() const noexcept { return loser_; }
+    [[nodiscard]] bool game_over() const noexcept { return alive_nb_ <= 1; }
+    [[nodiscard]] int winner() const noexcept;
+
+    // next player in the game clockwise from p
+    [[nodiscard]] int next_alive(int p) const noexcept {
+        do p = p + 1 == player_nb_ ? 0 : p + 1;
+        while (!cards_[p]);
+        return p;
+    }
+
+private:
+    std::array<Hand, PLAYER_NB_MAX> hands_{};
+    std::array<std::uint8_t, PLAYER_NB_MAX> cards_{}; // 0 once eliminated
+    std::array<std::uint8_t, BET_NB> bids_{};
+    Hand table_ = 0;
+    std::uint8_t player_nb_ = 0;
+    std::uint8_t alive_nb_ = 0;
+    std::uint8_t starter_ = 0;
+    std::uint8_t to_move_ = 0;
+    std::uint8_t bidder_ = 0; // who made the last bid
+    std::uint8_t bid_nb_ = 0;
+    std::int8_t loser_ = -1;
+    bool round_over_ = true;
+};
+
+static_assert(std::is_trivially_copyable_v<GameState>);
+
+template <std::uniform_random_bit_generator Rng>
+void GameState::deal(Rng& rng) {
+    // only the dealt prefix of the deck needs shuffling
+    std::array<Card, CARD_NB> deck;
+    for (int c = 0; c < CARD_NB; c++)
+        deck[c] = c;
+    int dealt = 0;
+    for (int p = 0; p < player_nb_; p++)
+        dealt += cards_[p];
+    for (int i = 0; i < dealt; i++) {
+        const int j = std::uniform_int_distribution<int>(i, CARD_NB - 1)(rng);
+        std::swap(deck[i], deck[j]);
+    }
+    deal(std::span<const Card, CARD_NB>(deck));
+}
+
+} // namespace thai_poker
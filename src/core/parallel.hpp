@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace thai_poker {
+
+// 0 means "one worker per hardware thread".
+[[nodiscard]] inline unsigned resolve_threads(unsigned threads) {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    return std::max(1U, threads);
+}
+
+// Calls fn(task, worker) for every task in [0, tasks). Tasks are handed out
+// dynamically, worker ids are dense in [0, threads) so callers can keep
+// per-worker scratch buffers. The first exception thrown by a task is
+// rethrown on the calling thread after all workers have joined.
+template <typename Fn>
+void parallel_for(int tasks, unsigned threads, Fn&& fn) {
+    threads = std::min<unsigned>(resolve_threads(threads), static_cast<unsigned>(std::max(tasks, 1)));
+    if (threads == 1) {
+        for (int task = 0; task < tasks; task++)
+            fn(task, 0U);
+        return;
+    }
+
+    std::atomic<int> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto work = [&](unsigned worker) {
+        try {
+            for (int task; (task = next.fetch_add(1)) < tasks; )
+                fn(task, worker);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+                error = std::current_exception();
+            next.store(tasks);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned worker = 1; worker < threads; worker++)
+        workers.emplace_back(work, worker);
+    work(0);
+    for (auto& t : workers)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace thai_poker
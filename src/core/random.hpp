@@ -0,0 +1,60 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace thai_poker {
+
+// Counter-based generator: the i-th output of a stream is a hash of
+// (seed, stream, i), so a game seeded with its own index draws the same cards
+// on whichever thread, and in whatever order, it is played. The hash is the
+// SplitMix64 finalizer.
+class CounterRng {
+public:
+    using result_type = std::uint64_t;
+
+    constexpr CounterRng(std::uint64_t seed, std::uint64_t stream) noexcept
+        : key(mix(seed ^ mix(stream + GAMMA))) { }
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept { return mix(key + ++counter * GAMMA); }
+
+    // moves to position i of the stream
+    constexpr void seek(std::uint64_t i) noexcept { counter = i; }
+
+private:
+    static constexpr std::uint64_t GAMMA = 0x9E3779B97F4A7C15ULL;
+
+    static constexpr std::uint64_t mix(std::uint64_t z) noexcept {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    std::uint64_t key;
+    std::uint64_t counter = 0;
+};
+
+// Uniform integer in [0, n) from one 64-bit draw by multiply-shift, without
+// the division and retry loop of std::uniform_int_distribution. The bias is
+// below n / 2^64.
+template <std::uniform_random_bit_generator Rng>
+    requires (Rng::min() == 0 && Rng::max() == std::numeric_limits<std::uint64_t>::max())
+[[nodiscard]] inline std::uint32_t uniform_below(Rng& rng, std::uint32_t n) noexcept {
+    __extension__ using u128 = unsigned __int128;
+    return static_cast<std::uint32_t>((static_cast<u128>(rng()) * n) >> 64);
+}
+
+// the same over [0, n) for n past 2^32; the bias is below n / 2^64
+template <std::uniform_random_bit_generator Rng>
+    requires (Rng::min() == 0 && Rng::max() == std::numeric_limits<std::uint64_t>::max())
+[[nodiscard]] inline std::uint64_t uniform_below_64(Rng& rng, std::uint64_t n) noexcept {
+    __extension__ using u128 = unsigned __int128;
+    return static_cast<std::uint64_t>((static_cast<u128>(rng()) * n) >> 64);
+}
+
+} // namespace thai_poker
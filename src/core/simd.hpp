@@ -0,0 +1,10 @@
+#pragma once
+
+// Hot loops marked with THAI_SIMD_CLONES are compiled once per listed
+// instruction set and dispatched at load time on the running CPU (GCC/Clang
+// ifunc). Elsewhere they fall back to a single portable build.
+#if defined(__x86_64__) && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define THAI_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define THAI_SIMD_CLONES
+#endif
@@ -1,7 +1,11 @@
 #include "thai_poker.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <stdexcept>
 
+#include "simd.hpp"
+
 namespace thai_poker {
 
 // internals
@@ -44,8 +48,157 @@ namespace {
     return ((h & ROYAL_POKER[to_i(s)]) == ROYAL_POKER[to_i(s)]);
 }
 
+constexpr int PROFILE_NB = 15625; // 5^RANK_NB per-rank card counts
+
+// a rank's four cards are one nibble, so the profile of a hand is the sum of
+// the profiles of its low and high 12 bits
+constexpr auto make_profile_part(int first_rank) {
+    std::array<std::uint16_t, 1U << 12> part{};
+    for (u32 bits = 0; bits < (1U << 12); bits++) {
+        int profile = 0, weight = 1;
+        for (int r = 0; r < RANK_NB; r++, weight *= 5) {
+            if (r >= first_rank && r < first_rank + 3)
+                profile += popcount(bits >> 4 * (r - first_rank) & 0xF) * weight;
+        }
+        part[bits] = static_cast<std::uint16_t>(profile);
+    }
+    return part;
+}
+
+constexpr auto PROFILE_LO = make_profile_part(0);
+constexpr auto PROFILE_HI = make_profile_part(3);
+
+[[nodiscard]] inline int rank_profile(Hand h) noexcept {
+    return PROFILE_LO[h & 0xFFF] + PROFILE_HI[h >> 12 & 0xFFF];
+}
+
+// bets decided by the per-rank counts alone (all of them below bet 64);
+// filled at load time, as a constant expression it exceeds GCC's ops limit
+const auto RANK_BETS = [] {
+    std::array<u64, PROFILE_NB> bets{};
+    for (int profile = 0; profile < PROFILE_NB; profile++) {
+        std::array<int, RANK_NB> cnt{};
+        for (int r = 0, p = profile; r < RANK_NB; r++, p /= 5)
+            cnt[r] = p % 5;
+
+        BetSet set;
+        for (int r = 0; r < RANK_NB; r++) {
+            if (cnt[r] >= 1) set.set(static_cast<Bet>(to_i(Bet::HIGH_9) + r));
+            if (cnt[r] >= 2) set.set(static_cast<Bet>(to_i(Bet::PAIR_9) + r));
+            if (cnt[r] >= 3) set.set(static_cast<Bet>(to_i(Bet::THREE_9) + r));
+            if (cnt[r] >= 4) set.set(static_cast<Bet>(to_i(Bet::QUADS_9) + r));
+        }
+        if (cnt[0] && cnt[1] && cnt[2] && cnt[3] && cnt[4]) set.set(Bet::LOW_STRAIGHT);
+        if (cnt[1] && cnt[2] && cnt[3] && cnt[4] && cnt[5]) set.set(Bet::HIGH_STRAIGHT);
+        for (int three = 0; three < RANK_NB; three++) {
+            for (int two = 0; two < RANK_NB; two++) {
+                if (three != two && cnt[three] >= 3 && cnt[two] >= 2)
+                    set.set(static_cast<Bet>(to_i(Bet::FULL_9T) + three * 5 + two - (two > three)));
+            }
+        }
+        bets[profile] = set.lo;
+    }
+    return bets;
+}();
+
+// highest bet decided by the per-rank counts alone, CHECK when the hand is empty
+constexpr auto BEST_RANK_BET = [] {
+    std::array<std::uint8_t, PROFILE_NB> best{};
+    for (int profile = 0; profile < PROFILE_NB; profile++) {
+        std::array<int, RANK_NB> cnt{};
+        for (int r = 0, p = profile; r < RANK_NB; r++, p /= 5)
+            cnt[r] = p % 5;
+        auto top = [&](int need, int except) {
+            for (int r = RANK_NB - 1; r >= 0; r--) {
+                if (r != except && cnt[r] >= need)
+                    return r;
+            }
+            return -1;
+        };
+
+        Bet bet = Bet::CHECK;
+        const int three = top(3, -1);
+        const int two = three < 0 ? -1 : top(2, three);
+        if (const int r = top(4, -1); r >= 0)
+            bet = static_cast<Bet>(to_i(Bet::QUADS_9) + r);
+        else if (two >= 0)
+            bet = static_cast<Bet>(to_i(Bet::FULL_9T) + three * 5 + two - (two > three));
+        else if (three >= 0)
+            bet = static_cast<Bet>(to_i(Bet::THREE_9) + three);
+        else if (cnt[1] && cnt[2] && cnt[3] && cnt[4] && cnt[5])
+            bet = Bet::HIGH_STRAIGHT;
+        else if (cnt[0] && cnt[1] && cnt[2] && cnt[3] && cnt[4])
+            bet = Bet::LOW_STRAIGHT;
+        else if (const int r = top(2, -1); r >= 0)
+            bet = static_cast<Bet>(to_i(Bet::PAIR_9) + r);
+        else if (const int r = top(1, -1); r >= 0)
+            bet = static_cast<Bet>(to_i(Bet::HIGH_9) + r);
+        best[profile] = static_cast<std::uint8_t>(bet);
+    }
+    return best;
+}();
+
+// Written to run one lane per hand: the per-rank counts are nibble popcounts
+// and a multiply sums the six cards of a suit into the top nibble, so the
+// only table is RANK_BETS. Lanes are 64 bits like the bet set, which makes
+// its load a gather.
+[[gnu::always_inline]] inline BetSet satisfied_bets_impl(u64 h) noexcept {
+    u64 cnt = h - (h >> 1 & 0x555555);
+    cnt = (cnt & 0x333333) + (cnt >> 2 & 0x333333);
+    const u64 profile = (cnt & 0xF) + (cnt >> 4 & 0xF) * 5 + (cnt >> 8 & 0xF) * 25
+                      + (cnt >> 12 & 0xF) * 125 + (cnt >> 16 & 0xF) * 625 + (cnt >> 20 & 0xF) * 3125;
+    BetSet set{RANK_BETS[profile], 0};
+    for (int s = 0; s < SUIT_NB; s++) {
+        const u64 suit = ((h >> s & 0x111111) * 0x111111) >> 20 & 0xF;
+        const u64 royal = (h & ROYAL_POKER[s]) == ROYAL_POKER[s];
+        const u64 small = (h & SMALL_POKER[s]) == SMALL_POKER[s];
+        set.lo |= u64{suit >= 5} << (to_i(Bet::FLUSH_C) + s);
+        set.lo |= (royal | small) << (to_i(Bet::POKER_C) + s);
+        set.hi |= royal << (to_i(Bet::ROYAL_POKER_C) - 64 + s);
+    }
+    return set;
+}
+
 } // namespace
 
+BetSet satisfied_bets(Hand h) noexcept {
+    return satisfied_bets_impl(h);
+}
+
+Bet best_bet(Hand h) noexcept {
+    for (int s = SUIT_NB - 1; s >= 0; s--) {
+        if ((h & ROYAL_POKER[s]) == ROYAL_POKER[s])
+            return static_cast<Bet>(to_i(Bet::ROYAL_POKER_C) + s);
+    }
+    for (int s = SUIT_NB - 1; s >= 0; s--) {
+        if ((h & SMALL_POKER[s]) == SMALL_POKER[s])
+            return static_cast<Bet>(to_i(Bet::POKER_C) + s);
+    }
+    const Bet rank_best = static_cast<Bet>(BEST_RANK_BET[rank_profile(h)]);
+    if (rank_best != Bet::CHECK && rank_best >= Bet::QUADS_9)
+        return rank_best;
+    for (int s = SUIT_NB - 1; s >= 0; s--) {
+        if (popcount(h & ALL_SUIT[s]) >= 5)
+            return static_cast<Bet>(to_i(Bet::FLUSH_C) + s);
+    }
+    return rank_best;
+}
+
+THAI_SIMD_CLONES
+void satisfied_bets(std::span<const Hand> hands, std::span<BetSet> out) noexcept {
+    assert(out.size() >= hands.size());
+    // RANK_BETS is written by its initializer, so GCC will not gather from
+    // it while storing to out; the lanes go through a local block
+    constexpr std::size_t LANES = 64;
+    BetSet lanes[LANES];
+    for (std::size_t i = 0; i < hands.size(); i += LANES) {
+        const std::size_t n = std::min(LANES, hands.size() - i);
+        for (std::size_t j = 0; j < n; j++)
+            lanes[j] = satisfied_bets_impl(hands[i + j]);
+        std::copy_n(lanes, n, out.begin() + i);
+    }
+}
+
 bool satisfies_bet(Hand h, Bet b) {
     int r, s, idx, three, two;
     switch (b) {
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
 #include <array>
 #include <bit>
+#include <span>
 
 namespace thai_poker {
 
 using u32 = std::uint32_t;
+using u64 = std::uint64_t;
 using Hand = u32; // 24-bit mask of present cards
 using Card = u32; // (suit | (rank << 2))
 
@@ -17,7 +20,7 @@ constexpr int BET_NB  = 68;
 constexpr int HAND_SZ = 6;
 constexpr int HAND_NB = 190051; // sum C(24, k) for k=0..6
 
-static inline int popcount(u32 v) { return std::popcount(v); }
+[[nodiscard]] constexpr int popcount(u32 v) noexcept { return std::popcount(v); }
 
 enum class Rank : int { RANK_9 = 0, RANK_T, RANK_J, RANK_Q, RANK_K, RANK_A };
 enum class Suit : int { SUIT_C = 0, SUIT_D, SUIT_H, SUIT_S };
@@ -103,6 +106,71 @@ static constexpr std::array<Hand, SUIT_NB> ROYAL_POKER = {
     mask_royal_poker(Suit::SUIT_H), mask_royal_poker(Suit::SUIT_S)
 };
 
+// Relabelling suits maps every deck onto one satisfying the same bets, with
+// FLUSH_x / POKER_x / ROYAL_POKER_x following their suit.
+constexpr int SUIT_PERM_NB = 24;
+using SuitPerm = std::array<int, SUIT_NB>; // suit s becomes perm[s]
+
+static constexpr std::array<SuitPerm, SUIT_PERM_NB> SUIT_PERMS = [] {
+    std::array<SuitPerm, SUIT_PERM_NB> perms{};
+    SuitPerm perm = {0, 1, 2, 3};
+    for (auto& p : perms) {
+        p = perm;
+        std::next_permutation(perm.begin(), perm.end());
+    }
+    return perms;
+}();
+
+[[nodiscard]] constexpr Hand permute_suits(Hand h, int perm) noexcept {
+    Hand out = 0;
+    for (int s = 0; s < SUIT_NB; s++) {
+        const int t = SUIT_PERMS[perm][s];
+        const Hand cards = h & ALL_SUIT[s];
+        out |= t >= s ? cards << (t - s) : cards >> (s - t);
+    }
+    return out;
+}
+
+[[nodiscard]] constexpr Bet permute_bet(Bet b, int perm) noexcept {
+    auto suited = [&](Bet first) {
+        return static_cast<Bet>(to_i(first) + SUIT_PERMS[perm][to_i(b) - to_i(first)]);
+    };
+    if (b >= Bet::FLUSH_C && b <= Bet::FLUSH_S) return suited(Bet::FLUSH_C);
+    if (b >= Bet::POKER_C && b <= Bet::POKER_S) return suited(Bet::POKER_C);
+    if (b >= Bet::ROYAL_POKER_C && b <= Bet::ROYAL_POKER_S) return suited(Bet::ROYAL_POKER_C);
+    return b;
+}
+
 [[nodiscard]] bool satisfies_bet(Hand h, Bet b);
 
+// Set of bets, bit to_i(b) for bet b.
+struct BetSet {
+    u64 lo = 0; // bets 0..63
+    u64 hi = 0; // bets 64..BET_NB-1
+
+    [[nodiscard]] constexpr bool test(Bet b) const noexcept {
+        const int i = to_i(b);
+        return i < 64 ? (lo >> i & 1) : (hi >> (i - 64) & 1);
+    }
+    constexpr void set(Bet b) noexcept {
+        const int i = to_i(b);
+        if (i < 64) lo |= u64{1} << i;
+        else        hi |= u64{1} << (i - 64);
+    }
+    [[nodiscard]] constexpr bool empty() const noexcept { return (lo | hi) == 0; }
+    constexpr bool operator==(BetSet const&) const = default;
+};
+
+// Every bet satisfied by h in one pass: the rank-based bets come from one
+// table load keyed by the per-rank card counts, the suited ones from the
+// suit masks above.
+[[nodiscard]] BetSet satisfied_bets(Hand h) noexcept;
+// out[i] = satisfied_bets(hands[i]), a vector of hands at a time on CPUs
+// with gathers (AVX2 and up); out must be at least as large as hands
+void satisfied_bets(std::span<const Hand> hands, std::span<BetSet> out) noexcept;
+
+// Highest-ranked bet satisfied by h (what a check has to beat), Bet::CHECK
+// for the empty hand. A few table loads, no scan over the bets.
+[[nodiscard]] Bet best_bet(Hand h) noexcept;
+
 } // namespace thai_poker
\ No newline at end of file
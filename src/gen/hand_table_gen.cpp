@@ -0,0 +1,86 @@
+// Build step: emits the HandTable arrays as a constant-initialized
+// translation unit, so no process pays for generating them at startup.
+
+#include <array>
+#include <cstdio>
+#include <vector>
+
+#include "logic/hand_table.hpp"
+
+using namespace thai_poker;
+
+template <typename T, std::size_t N>
+void emit(std::FILE* out, const char* declaration, std::array<T, N> const& values) {
+    std::fprintf(out, "constinit const %s = {", declaration);
+    for (std::size_t i = 0; i < N; i++)
+        std::fprintf(out, "%s0x%x,", i % 16 ? "" : "\n    ", static_cast<unsigned>(values[i]));
+    std::fprintf(out, "\n};\n\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <output.cpp>\n", argv[0]);
+        return 1;
+    }
+
+    static std::array<Hand, HAND_NB> index_to_hand{};
+    int idx = 0;
+    for (Hand h = 0; h < (1U << CARD_NB); h++) {
+        if (popcount(h) <= HAND_SZ) {
+            if (idx == HAND_NB || HandTable::rank(h) != idx) {
+                std::fprintf(stderr, "HAND_NB mismatch - constant or generation is wrong\n");
+                return 1;
+            }
+            index_to_hand[idx++] = h;
+        }
+    }
+
+    // hands are visited in mask order, so a representative (the orbit
+    // minimum) is always seen before the rest of its orbit
+    static std::array<std::uint32_t, HAND_NB> index_to_canonical{};
+    static std::array<Hand, CANONICAL_NB> canonical_to_hand{};
+    int classes = 0;
+    for (int i = 0; i < HAND_NB; i++) {
+        Hand h = index_to_hand[i];
+        Hand best = h;
+        std::uint32_t best_perm = 0;
+        for (int perm = 1; perm < SUIT_PERM_NB; perm++) {
+            Hand p = permute_suits(h, perm);
+            if (p < best) {
+                best = p;
+                best_perm = perm;
+            }
+        }
+
+        std::uint32_t cls;
+        if (best == h) {
+            if (classes == CANONICAL_NB) {
+                std::fprintf(stderr, "CANONICAL_NB mismatch\n");
+                return 1;
+            }
+            cls = classes;
+            canonical_to_hand[classes++] = h;
+        }
+        else {
+            cls = index_to_canonical[HandTable::rank(best)] >> 5;
+        }
+        index_to_canonical[i] = cls << 5 | best_perm;
+    }
+    if (classes != CANONICAL_NB) {
+        std::fprintf(stderr, "CANONICAL_NB mismatch: %d classes\n", classes);
+        return 1;
+    }
+
+    std::FILE* out = std::fopen(argv[1], "w");
+    if (!out) {
+        std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::fprintf(out, "// generated by src/gen/hand_table_gen.cpp, do not edit\n\n");
+    std::fprintf(out, "#include \"logic/hand_table.hpp\"\n\nnamespace thai_poker {\n\n");
+    emit(out, "std::array<Hand, HAND_NB> HandTable::index_to_hand", index_to_hand);
+    emit(out, "std::array<std::uint32_t, HAND_NB> HandTable::index_to_canonical", index_to_canonical);
+    emit(out, "std::array<Hand, CANONICAL_NB> HandTable::canonical_to_hand", canonical_to_hand);
+    std::fprintf(out, "} // namespace thai_poker\n");
+    return std::fclose(out) == 0 ? 0 : 1;
+}
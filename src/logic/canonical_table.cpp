@@ -0,0 +1,96 @@
+#include "canonical_table.hpp"
+
+#include <cstring>
+#include <iostream>
+
+#include "../core/parallel.hpp"
+#include "superset_count.hpp"
+
+namespace thai_poker {
+
+CanonicalProbabilityTable::CanonicalProbabilityTable(const std::string &filename)
+    : table_(HandTable::instance()), classes_(table_.canonical_nb()) {
+    if (load(filename)) {
+        std::cerr << "Canonical probability table loaded" << std::endl;
+    }
+    else {
+        std::cerr << "Building canonical probability table" << std::endl;
+        build();
+        save(filename);
+    }
+}
+
+CanonicalProbabilityTable& CanonicalProbabilityTable::instance() {
+    static CanonicalProbabilityTable singleton(std::string(DATA_DIR) + "/TTC0.bin");
+    return singleton;
+}
+
+int CanonicalProbabilityTable::get_comp(Bet b, int card_nb, Hand h) const {
+    if (card_nb < 0 || card_nb > CARD_NB)
+        throw std::out_of_range("card_nb");
+    int hand_index = table_.to_index(h);
+    if (hand_index < 0 || hand_index >= HAND_NB)
+        throw std::out_of_range("hand does not exist");
+    auto [canonical_index, perm] = table_.to_canonical(h);
+    return P_[offset(to_i(permute_bet(b, perm)), card_nb, canonical_index)];
+}
+
+double CanonicalProbabilityTable::get_prob(Bet b, int card_nb, Hand h) const {
+    if (b == Bet::CHECK)
+        return 0.0;
+    int in_hand = popcount(h);
+    return get_comp(b, card_nb, h) * comb_.get_inv(CARD_NB - in_hand, card_nb - in_hand);
+}
+
+void CanonicalProbabilityTable::build(unsigned threads) {
+    P_.assign(static_cast<std::size_t>(BET_NB) * (CARD_NB+1) * classes_, 0);
+    parallel_for(BET_NB, threads, [&](int bet, unsigned) {
+        SupersetCounter counter(static_cast<Bet>(bet));
+        for (int canonical_index = 0; canonical_index < classes_; canonical_index++) {
+            auto const& counts = counter.counts(table_.from_canonical(canonical_index));
+            for (int card_nb = 0; card_nb <= CARD_NB; card_nb++)
+                P_[offset(bet, card_nb, canonical_index)] = counts[card_nb];
+        }
+    });
+}
+
+bool CanonicalProbabilityTable::load(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char magic[4];
+    if (std::fread(magic, 1, 4, f) != 4 || std::memcmp(magic, "TTC0", 4) != 0) {
+        std::fclose(f);
+        return false;
+    }
+
+    u32 version=0, bets=0, cards=0, classes=0;
+    std::fread(&version, 4, 1, f);
+    std::fread(&bets, 4, 1, f);
+    std::fread(&cards, 4, 1, f);
+    std::fread(&classes, 4, 1, f);
+    if (version != VERSION || bets != BET_NB || cards != CARD_NB+1 || classes != static_cast<u32>(classes_)) {
+        std::fclose(f);
+        throw std::runtime_error("Canonical P table dim/version mismatch");
+    }
+    P_.resize(static_cast<std::size_t>(BET_NB) * (CARD_NB+1) * classes_);
+    size_t got = std::fread(P_.data(), sizeof(int), P_.size(), f);
+    std::fclose(f);
+    if (got != P_.size())
+        throw std::runtime_error("Could not read canonical P table from " + path);
+    return true;
+}
+
+void CanonicalProbabilityTable::save(const std::string& path) const {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("Cannot open " + path);
+    std::fwrite("TTC0", 1, 4, f);
+    u32 version = VERSION, bets = BET_NB, cards = CARD_NB+1, classes = static_cast<u32>(classes_);
+    std::fwrite(&version, 4, 1, f);
+    std::fwrite(&bets, 4, 1, f);
+    std::fwrite(&cards, 4, 1, f);
+    std::fwrite(&classes, 4, 1, f);
+    std::fwrite(P_.data(), sizeof(int), P_.size(), f);
+    std::fclose(f);
+}
+
+} // namespace thai_poker
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../core/thai_poker.hpp"
+#include "combinatorics.hpp"
+#include "hand_table.hpp"
+
+namespace thai_poker {
+
+// ProbabilityTable restricted to one hand per suit-relabelling class.
+// Queries map the hand onto its representative and suited bets along with
+// it, so get_comp/get_prob are exact and match ProbabilityTable while the
+// table is ~20x smaller.
+class CanonicalProbabilityTable {
+public:
+    static constexpr int VERSION = 1;
+
+    CanonicalProbabilityTable(const std::string&);
+    CanonicalProbabilityTable(const CanonicalProbabilityTable&) = delete;
+    CanonicalProbabilityTable& operator=(const CanonicalProbabilityTable&) = delete;
+
+    static CanonicalProbabilityTable& instance();
+
+    [[nodiscard]] double get_prob(Bet b, int card_nb, Hand h) const;
+    [[nodiscard]] int get_comp(Bet b, int card_nb, Hand h) const;
+    void build(unsigned threads = 0);
+    bool load(const std::string& path);
+    void save(const std::string& path) const;
+
+private:
+
+    [[nodiscard]] std::size_t offset(int bet, int card_nb, int canonical_index) const {
+        return (static_cast<std::size_t>(bet) * (CARD_NB+1) + card_nb) * classes_ + canonical_index;
+    }
+
+    static constexpr Comb24 const& comb_ = COMB24;
+    HandTable const& table_;
+    int classes_;
+    std::vector<int> P_; // P_[bet][card_nb][canonical_index]
+};
+
+} // namespace thai_poker
@@ -8,10 +8,26 @@ struct Comb24 {
     int C[CARD_NB + 1][CARD_NB + 1]{};
     double I[CARD_NB + 1][CARD_NB + 1]{};
 
-    Comb24();
+    constexpr Comb24() {
+        C[0][0] = 1;
+        for (int n = 1; n <= CARD_NB; n++) {
+            C[n][0] = C[n][n] = 1;
+            for (int k = 1; k < n; k++)
+                C[n][k] = C[n-1][k] + C[n-1][k-1];
+        }
 
-    int get(int n, int k) const;
-    double get_inv(int n, int k) const;
+        for (int n = 0; n <= CARD_NB; n++) {
+            for (int k = 0; k <= n; k++) {
+                I[n][k] = (double) 1 / C[n][k];
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr int get(int n, int k) const { return C[n][k]; }
+    [[nodiscard]] constexpr double get_inv(int n, int k) const { return I[n][k]; }
 };
 
-} // namespace thai_poker
\ No newline at end of file
+// built by the compiler, no startup cost
+inline constexpr Comb24 COMB24{};
+
+} // namespace thai_poker
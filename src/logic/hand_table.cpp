@@ -2,8 +2,12 @@
 
 namespace thai_poker {
 
+// index_to_hand, index_to_canonical and canonical_to_hand are defined in
+// hand_table_data.cpp, generated at build time by src/gen/hand_table_gen.cpp
+
+#ifndef THAI_HAND_INDEX_RANK
 std::array<int, 1U << CARD_NB> HandTable::hand_to_index{};
-std::array<Hand, HAND_NB> HandTable::index_to_hand{};
+#endif
 
 HandTable& HandTable::instance() {
     static HandTable singleton;
@@ -11,29 +15,36 @@ HandTable& HandTable::instance() {
 }
 
 HandTable::HandTable() {
-    int idx = 0;
-    for (u32 h = 0; h < (1U << CARD_NB); h++) {
-        if (popcount(h) <= HAND_SZ) {
-            hand_to_index[h] = idx;
-            index_to_hand[idx] = h;
-            idx++;
-        }
-        else {
-            hand_to_index[h] = -1;
-        }
-    }
-
-    if (idx != HAND_NB) {
-        throw std::runtime_error("HAND_NB mismatch - constant or generation is wrong");
-    }
+#ifndef THAI_HAND_INDEX_RANK
+    hand_to_index.fill(-1);
+    for (int idx = 0; idx < HAND_NB; idx++)
+        hand_to_index[index_to_hand[idx]] = idx;
+#endif
 }
 
 int HandTable::to_index(Hand h) const {
+#ifdef THAI_HAND_INDEX_RANK
+    return rank(h);
+#else
     return hand_to_index[h];
+#endif
 }
 
 Hand HandTable::from_index(int idx) const {
     return index_to_hand[idx];
 }
 
-} // namespace thai_poker
\ No newline at end of file
+HandTable::Canonical HandTable::to_canonical(Hand h) const {
+    std::uint32_t packed = index_to_canonical[to_index(h)];
+    return Canonical{static_cast<int>(packed >> 5), static_cast<int>(packed & 31)};
+}
+
+Hand HandTable::from_canonical(int canonical_index) const {
+    return canonical_to_hand[canonical_index];
+}
+
+int HandTable::canonical_nb() const {
+    return CANONICAL_NB;
+}
+
+} // namespace thai_poker
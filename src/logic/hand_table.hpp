@@ -1,11 +1,16 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <cstdint>
 #include <stdexcept>
 
 #include "../core/thai_poker.hpp"
 
 namespace thai_poker {
 
+constexpr int CANONICAL_NB = 10188; // hand classes up to suit relabelling
+
 class HandTable {
 public:
     HandTable(const HandTable&) = delete;
@@ -16,13 +21,106 @@ public:
     [[nodiscard]] int to_index(Hand h) const;
     [[nodiscard]] Hand from_index(int idx) const;
 
+    // Hands are indexed in increasing mask order among masks with at most
+    // HAND_SZ cards, so an index is the number of such masks below the hand.
+    // rank/unrank compute it with the combinatorial number system instead of
+    // the 2^24 lookup array, rank from two 12-bit half tables (128 KB);
+    // THAI_HAND_INDEX_RANK makes to_index use rank and drops the array.
+    [[nodiscard]] static constexpr int rank(Hand h) noexcept;
+    [[nodiscard]] static constexpr Hand unrank(int idx) noexcept;
+
+    // Hands equal up to a suit relabelling share one canonical class; the
+    // representative is the smallest mask in the orbit and
+    // permute_suits(h, perm) maps h onto it.
+    struct Canonical {
+        int index;
+        int perm;
+    };
+
+    [[nodiscard]] Canonical to_canonical(Hand h) const;
+    [[nodiscard]] Hand from_canonical(int canonical_index) const;
+    [[nodiscard]] int canonical_nb() const;
+
 private:
 
     HandTable();
 
+    // BELOW[p][j]: masks over the low p bits with at most HAND_SZ - j cards
+    static constexpr auto BELOW = [] {
+        std::array<std::array<int, HAND_SZ + 1>, CARD_NB> below{};
+        for (int p = 0; p < CARD_NB; p++) {
+            long long c = 1; // C(p, k)
+            int sum = 0;
+            std::array<int, HAND_SZ + 1> prefix{};
+            for (int k = 0; k <= HAND_SZ; k++) {
+                sum += static_cast<int>(c);
+                prefix[k] = sum;
+                c = c * (p - k) / (k + 1);
+            }
+            for (int j = 0; j <= HAND_SZ; j++)
+                below[p][j] = prefix[HAND_SZ - j];
+        }
+        return below;
+    }();
+
+    // rank() splits a mask into 12-bit halves: the masks below h are those
+    // with a smaller high half, HIGH_BELOW[h_hi], plus those sharing it with
+    // a smaller low half, LOW_BELOW[h_lo][HAND_SZ - popcount(h_hi)]
+    static constexpr int HALF_BITS = CARD_NB / 2;
+    static_assert(HALF_BITS > HAND_SZ);
+    static constexpr auto LOW_BELOW = [] {
+        // LOW_BELOW[lo][j]: masks below lo with at most j cards
+        std::array<std::array<int, HAND_SZ + 1>, 1 << HALF_BITS> low{};
+        for (int lo = 1; lo < 1 << HALF_BITS; lo++) {
+            for (int j = 0; j <= HAND_SZ; j++)
+                low[lo][j] = low[lo - 1][j] + (std::popcount(static_cast<unsigned>(lo - 1)) <= j);
+        }
+        return low;
+    }();
+    static constexpr auto HIGH_BELOW = [] {
+        // a high half hi - 1 leaves room for free low cards; the all-ones low
+        // half has more than HAND_SZ cards, so the masks below it are all of
+        // those low halves
+        std::array<int, 1 << HALF_BITS> high{};
+        for (int hi = 1; hi < 1 << HALF_BITS; hi++) {
+            const int free = HAND_SZ - std::popcount(static_cast<unsigned>(hi - 1));
+            high[hi] = high[hi - 1] + (free < 0 ? 0 : LOW_BELOW[(1 << HALF_BITS) - 1][free]);
+        }
+        return high;
+    }();
+
+    // generated at build time, see src/gen/hand_table_gen.cpp
+    static const std::array<Hand, HAND_NB> index_to_hand;
+    // canonical_index << 5 | perm, by hand index
+    static const std::array<std::uint32_t, HAND_NB> index_to_canonical;
+    static const std::array<Hand, CANONICAL_NB> canonical_to_hand;
+
+#ifndef THAI_HAND_INDEX_RANK
+    // too large to embed in the binary, filled by the first instance()
     static std::array<int, 1U << CARD_NB> hand_to_index;
-    static std::array<Hand, HAND_NB> index_to_hand;
+#endif
 
 };
 
-} // namespace thai_poker
\ No newline at end of file
+constexpr int HandTable::rank(Hand h) noexcept {
+    const int cards = popcount(h);
+    if (cards > HAND_SZ || h >> CARD_NB)
+        return -1;
+    const Hand hi = h >> HALF_BITS, lo = h & ((1u << HALF_BITS) - 1);
+    return HIGH_BELOW[hi] + LOW_BELOW[lo][HAND_SZ - popcount(hi)];
+}
+
+constexpr Hand HandTable::unrank(int idx) noexcept {
+    Hand h = 0;
+    int cards = 0;
+    for (int p = CARD_NB - 1; p >= 0 && cards < HAND_SZ; p--) {
+        const int below = BELOW[p][cards];
+        const bool set = idx >= below;
+        h |= static_cast<Hand>(set) << p;
+        idx -= set ? below : 0;
+        cards += set;
+    }
+    return h;
+}
+
+} // namespace thai_poker
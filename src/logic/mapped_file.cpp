@@ -0,0 +1,87 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define THAI_HAS_MMAP 1
+#endif
+
+namespace thai_poker {
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef THAI_HAS_MMAP
+
+bool MappedFile::open(const std::string& path, bool populate, Access access) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate) flags |= MAP_POPULATE;
+#else
+    (void) populate;
+#endif
+    void* addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, flags, fd, 0);
+    ::close(fd); // the mapping keeps its own reference
+    if (addr == MAP_FAILED) return false;
+
+    int advice = MADV_NORMAL;
+    switch (access) {
+        case Access::Normal:     advice = MADV_NORMAL; break;
+        case Access::Sequential: advice = MADV_SEQUENTIAL; break;
+        case Access::Random:     advice = MADV_RANDOM; break;
+        case Access::WillNeed:   advice = MADV_WILLNEED; break;
+    }
+    ::madvise(addr, static_cast<std::size_t>(st.st_size), advice);
+
+    data_ = static_cast<const std::byte*>(addr);
+    size_ = static_cast<std::size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        ::munmap(const_cast<std::byte*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+#else
+
+bool MappedFile::open(const std::string&, bool, Access) {
+    return false;
+}
+
+void MappedFile::close() {}
+
+#endif
+
+} // namespace thai_poker
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace thai_poker {
+
+// Read-only memory mapping of a whole file. Pages come from the shared page
+// cache, so every process mapping the same file shares one resident copy.
+class MappedFile {
+public:
+    enum class Access { Normal, Sequential, Random, WillNeed };
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) noexcept;
+    MappedFile& operator=(MappedFile&&) noexcept;
+    ~MappedFile();
+
+    // false if the file cannot be opened or mapping is not supported here;
+    // populate pre-faults every page (MAP_POPULATE), access is an madvise hint
+    bool open(const std::string& path, bool populate = false, Access access = Access::Normal);
+    void close();
+
+    [[nodiscard]] bool is_open() const { return data_ != nullptr; }
+    [[nodiscard]] const std::byte* data() const { return data_; }
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+private:
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace thai_poker
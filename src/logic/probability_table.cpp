@@ -1,77 +1,324 @@
 #include "probability_table.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "../core/parallel.hpp"
+#include "subset_sum.hpp"
+#include "superset_count.hpp"
 
 namespace thai_poker {
 
-int ProbabilityTable::P_[BET_NB][CARD_NB+1][HAND_NB]{};
+ProbabilityTable::ProbabilityTable(const std::string &filename)
+    : ProbabilityTable(filename, Options{}) {}
 
-ProbabilityTable::ProbabilityTable(const std::string &filename) : table_(HandTable::instance()) {
+ProbabilityTable::ProbabilityTable(const std::string &filename, Options options)
+    : options_(options), table_(HandTable::instance()) {
     if (load(filename)) {
-        std::cerr << "Probability table loaded" << std::endl;
+        std::cerr << (lazy_ ? "Probability table: lazy slices" : "Probability table loaded") << std::endl;
     }
     else {
-        std::cerr << "Building probability table (~4-10min)" << std::endl;
-        build();
+        std::cerr << "Building probability table" << std::endl;
+        build_analytic();
+        if (options_.load_mode == LoadMode::Quantized)
+            quantize();
         save(filename);
     }
 }
 
+ProbabilityTable::~ProbabilityTable() {
+    close_slice_file();
+}
+
+ProbabilityTable::Options& ProbabilityTable::default_options() {
+    static Options options;
+    return options;
+}
+
+void ProbabilityTable::configure(Options options) {
+    default_options() = options;
+}
+
 ProbabilityTable& ProbabilityTable::instance() {
-    static ProbabilityTable singleton(std::string(DATA_DIR) + "/TTP0.bin");
+    auto file_name = [](LoadMode mode) {
+        switch (mode) {
+            case LoadMode::Quantized: return "/TTQ0.bin";
+            case LoadMode::Lazy: return "/TTS0.bin";
+            default: return "/TTP0.bin";
+        }
+    };
+    static ProbabilityTable singleton(std::string(DATA_DIR) + file_name(default_options().load_mode),
+                                      default_options());
     return singleton;
 }
 
-int ProbabilityTable::get_comp(Bet b, int card_nb, Hand h) const {
+void ProbabilityTable::make_writable(bool keep) {
+    if (!owned_) {
+        owned_ = std::make_unique_for_overwrite<int[]>(TABLE_SIZE);
+        if (keep && P_)
+            std::copy(P_, P_ + TABLE_SIZE, owned_.get());
+        P_ = owned_.get();
+    }
+    mapped_.close();
+    quant_ = QuantizedTable{};
+    quantized_ = false;
+    lazy_ = false;
+    close_slice_file();
+}
+
+void ProbabilityTable::quantize() {
+    quant_ = QuantizedTable::from(*this, options_.quantized_bits);
+    quantized_ = true;
+    owned_.reset();
+    mapped_.close();
+    P_ = nullptr;
+    std::cerr << "Quantized to " << quant_.bits() << " bits, max error " << quant_.max_error() << std::endl;
+}
+
+int ProbabilityTable::checked_index(int card_nb, Hand h) const {
     if (card_nb < 0 || card_nb > CARD_NB)
         throw std::out_of_range("card_nb");
     int hand_index = table_.to_index(h);
     if (hand_index < 0 || hand_index >= HAND_NB)
         throw std::out_of_range("hand does not exist");
-    return P_[to_i(b)][card_nb][hand_index];
+    return hand_index;
+}
+
+int ProbabilityTable::get_comp(Bet b, int card_nb, Hand h) const {
+    if (quantized_)
+        throw std::logic_error("exact counts are not kept in quantized mode");
+    return comp_at(to_i(b), card_nb, checked_index(card_nb, h));
+}
+
+void ProbabilityTable::get_comp_vector(int card_nb, Hand h, std::span<int, BET_NB> out) const {
+    if (quantized_)
+        throw std::logic_error("exact counts are not kept in quantized mode");
+    int hand_index = checked_index(card_nb, h);
+    if (!lazy_ && options_.layout == Layout::HandMajor) {
+        std::memcpy(out.data(), P_ + offset(0, card_nb, hand_index), BET_NB * sizeof(int));
+        return;
+    }
+    for (int bet = 0; bet < BET_NB; bet++)
+        out[bet] = comp_at(bet, card_nb, hand_index);
+}
+
+void ProbabilityTable::get_prob_vector(int card_nb, Hand h, std::span<float, BET_NB> out) const {
+    if (quantized_) {
+        int hand_index = checked_index(card_nb, h);
+        for (int bet = 0; bet < BET_NB; bet++)
+            out[bet] = static_cast<float>(quant_.get_prob(static_cast<Bet>(bet), card_nb, hand_index));
+        return;
+    }
+    std::array<int, BET_NB> comp;
+    get_comp_vector(card_nb, h, comp);
+    int in_hand = popcount(h);
+    const double inv = comb_.get_inv(CARD_NB - in_hand, card_nb - in_hand);
+    for (int bet = 0; bet < BET_NB; bet++)
+        out[bet] = static_cast<float>(comp[bet] * inv);
 }
 
 double ProbabilityTable::get_prob(Bet b, int card_nb, Hand h) const {
     if (b == Bet::CHECK)
         return 0.0;
+    if (quantized_)
+        return quant_.get_prob(b, card_nb, checked_index(card_nb, h));
     int in_hand = popcount(h);
     // P of satisfied bet = # (possible games with satisfied bet) / # of possible games
     return get_comp(b, card_nb, h) * comb_.get_inv(CARD_NB - in_hand, card_nb - in_hand);
 }
 
-void ProbabilityTable::build() {
-    std::vector<int> H(1U << CARD_NB);
-    for (int bet = 0; bet < BET_NB; bet++) {
-        std::cerr << "Bet: " << bet << '\n';
-        for (int card_nb = 0; card_nb <= CARD_NB; card_nb++) {
-            for (Hand deck = 0; deck < (1U << CARD_NB); deck++) {
-                if (popcount(deck) == card_nb &&
-                    satisfies_bet(deck, static_cast<Bet>(bet)))
-                    H[deck] = 1;
-                else
-                    H[deck] = 0;
-            }
+const int* ProbabilityTable::lazy_slice(int bet, int card_nb) const {
+    const std::size_t slice = static_cast<std::size_t>(bet) * (CARD_NB+1) + card_nb;
+    if (const int* data = lazy_slices_[slice].load(std::memory_order_acquire))
+        return data;
 
-            // SOS dp
-            for (int card = 0; card < CARD_NB; card++) {
-                for (Hand deck = 0; deck < (1U << CARD_NB); deck++) {
-                    if ((deck >> card & 1) == 0) {
-                        H[deck] += H[deck ^ (1 << card)];
-                    }
-                }
-            }
+    // a slice takes milliseconds, so first touches simply serialize here
+    std::lock_guard<std::mutex> lock(lazy_mutex_);
+    if (const int* data = lazy_slices_[slice].load(std::memory_order_relaxed))
+        return data;
+
+    auto data = std::make_unique_for_overwrite<int[]>(HAND_NB);
+    const long at = static_cast<long>(SLICE_FILE_DATA + slice * HAND_NB * sizeof(int));
+    char present = 0;
+    bool cached = slice_file_ &&
+        std::fseek(slice_file_, static_cast<long>(HEADER_SIZE + slice), SEEK_SET) == 0 &&
+        std::fread(&present, 1, 1, slice_file_) == 1 && present &&
+        std::fseek(slice_file_, at, SEEK_SET) == 0 &&
+        std::fread(data.get(), sizeof(int), HAND_NB, slice_file_) == HAND_NB;
+
+    if (!cached) {
+        SupersetCounter counter(static_cast<Bet>(bet));
+        for (int hand_index = 0; hand_index < HAND_NB; hand_index++)
+            data[hand_index] = counter.counts(table_.from_index(hand_index))[card_nb];
+
+        // data first, then the flag, so a crash never leaves a bad slice
+        if (slice_file_) {
+            present = 1;
+            bool written = std::fseek(slice_file_, at, SEEK_SET) == 0 &&
+                std::fwrite(data.get(), sizeof(int), HAND_NB, slice_file_) == HAND_NB &&
+                std::fflush(slice_file_) == 0 &&
+                std::fseek(slice_file_, static_cast<long>(HEADER_SIZE + slice), SEEK_SET) == 0 &&
+                std::fwrite(&present, 1, 1, slice_file_) == 1 &&
+                std::fflush(slice_file_) == 0;
+            if (!written)
+                std::cerr << "Could not persist probability slice " << slice << std::endl;
+        }
+    }
+
+    lazy_owned_[slice] = std::move(data);
+    lazy_slices_[slice].store(lazy_owned_[slice].get(), std::memory_order_release);
+    return lazy_owned_[slice].get();
+}
+
+bool ProbabilityTable::open_slice_file(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "r+b");
+    if (f) {
+        char magic[4];
+        u32 header[4];
+        if (std::fread(magic, 1, 4, f) != 4 || std::memcmp(magic, "TTS0", 4) != 0 ||
+            std::fread(header, 4, 4, f) != 4) {
+            std::fclose(f);
+            return false;
+        }
+        auto [version, bets, cards, hands] = header;
+        if (version != VERSION || bets != BET_NB || cards != CARD_NB+1 || hands != HAND_NB) {
+            std::fclose(f);
+            throw std::runtime_error("P slice file dim/version mismatch");
+        }
+    }
+    else {
+        f = std::fopen(path.c_str(), "w+b");
+        if (!f) return false;
+        std::fwrite("TTS0", 1, 4, f);
+        u32 header[4] = {VERSION, BET_NB, CARD_NB+1, HAND_NB};
+        std::fwrite(header, 4, 4, f);
+        std::vector<char> present(SLICE_NB, 0);
+        std::fwrite(present.data(), 1, SLICE_NB, f);
+        std::fflush(f);
+    }
+    slice_file_ = f;
+    return true;
+}
+
+void ProbabilityTable::close_slice_file() {
+    if (slice_file_) {
+        std::fclose(slice_file_);
+        slice_file_ = nullptr;
+    }
+}
 
-            for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
-                Hand hand = table_.from_index(hand_index);
-                P_[bet][card_nb][hand_index] = H[hand];
+void ProbabilityTable::build(unsigned threads) {
+    std::vector<int> slices(SLICE_NB);
+    std::iota(slices.begin(), slices.end(), 0);
+    build(threads, slices);
+}
+
+void ProbabilityTable::build(unsigned threads, std::span<const int> slices) {
+    for (int slice : slices) {
+        if (slice < 0 || static_cast<std::size_t>(slice) >= SLICE_NB)
+            throw std::out_of_range("ProbabilityTable::build: slice");
+    }
+    const bool partial = slices.size() < SLICE_NB;
+    if (partial && (quantized_ || lazy_))
+        throw std::logic_error("ProbabilityTable::build: other slices are not exact");
+    make_writable(partial);
+    threads = resolve_threads(threads);
+    std::cerr << "Building with " << threads << " thread(s)" << std::endl;
+
+    // every (bet, card_nb) slice is independent, each worker owns one 64 MB H
+    std::vector<std::vector<int>> scratch(threads);
+    std::array<std::atomic<int>, BET_NB> slices_done{};
+
+    parallel_for(static_cast<int>(slices.size()), threads, [&](int task, unsigned worker) {
+        const int bet = slices[task] / (CARD_NB + 1);
+        const int card_nb = slices[task] % (CARD_NB + 1);
+
+        std::vector<int>& H = scratch[worker];
+        if (H.empty())
+            H.resize(1U << CARD_NB);
+        build_slice(bet, card_nb, H);
+
+        if (++slices_done[bet] == CARD_NB + 1)
+            std::cerr << ("Bet: " + std::to_string(bet) + '\n');
+    });
+}
+
+void ProbabilityTable::build_analytic(unsigned threads) {
+    make_writable();
+    parallel_for(BET_NB, threads, [&](int bet, unsigned) {
+        SupersetCounter counter(static_cast<Bet>(bet));
+        for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
+            auto const& counts = counter.counts(table_.from_index(hand_index));
+            for (int card_nb = 0; card_nb <= CARD_NB; card_nb++)
+                P_[offset(bet, card_nb, hand_index)] = counts[card_nb];
+        }
+    });
+}
+
+void ProbabilityTable::build_slice(int bet, int card_nb, std::vector<int>& H) {
+    std::fill(H.begin(), H.end(), 0);
+
+    // only decks of exactly card_nb cards are set; walk them in increasing
+    // order (Gosper's hack) and evaluate a block at a time
+    constexpr int BLOCK = 4096;
+    std::array<Hand, BLOCK> decks;
+    std::array<BetSet, BLOCK> sets;
+    const Hand end = 1U << CARD_NB;
+    Hand deck = (1U << card_nb) - 1;
+    while (deck < end) {
+        int n = 0;
+        for (; n < BLOCK && deck < end; n++) {
+            decks[n] = deck;
+            if (deck == 0)
+                deck = end;
+            else {
+                const Hand low = deck & -deck;
+                const Hand ripple = deck + low;
+                deck = (((ripple ^ deck) >> 2) / low) | ripple;
             }
         }
+        satisfied_bets(std::span(decks.data(), n), sets);
+        for (int i = 0; i < n; i++)
+            H[decks[i]] = sets[i].test(static_cast<Bet>(bet));
+    }
+
+    // SOS dp
+    superset_sum(H.data(), CARD_NB);
+
+    for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
+        Hand hand = table_.from_index(hand_index);
+        P_[offset(bet, card_nb, hand_index)] = H[hand];
     }
 }
 
 bool ProbabilityTable::load(const std::string& path) {
+    if (options_.load_mode == LoadMode::Lazy) {
+        owned_.reset();
+        mapped_.close();
+        P_ = nullptr;
+        lazy_ = true;
+        if (options_.persist_slices && !open_slice_file(path))
+            std::cerr << "Cannot open " << path << ", slices will not be persisted" << std::endl;
+        return true;
+    }
+    if (options_.load_mode == LoadMode::Quantized) {
+        if (!quant_.load(path))
+            return false;
+        owned_.reset();
+        mapped_.close();
+        P_ = nullptr;
+        quantized_ = true;
+        return true;
+    }
+    if (options_.load_mode == LoadMode::Mmap && load_mmap(path))
+        return true;
+
     FILE* f = std::fopen(path.c_str(), "rb");
     if (!f) return false;
     char magic[4];
@@ -89,15 +336,59 @@ bool ProbabilityTable::load(const std::string& path) {
         std::fclose(f);
         throw std::runtime_error("P table dim/version mismatch");
     }
-    size_t need = BET_NB * (CARD_NB+1) * HAND_NB;
-    size_t got = std::fread(P_, sizeof(int), need, f);
+    make_writable();
+    bool ok = true;
+    if (options_.layout == Layout::BetMajor) {
+        ok = std::fread(P_, sizeof(int), TABLE_SIZE, f) == TABLE_SIZE;
+    }
+    else {
+        std::vector<int> slice(HAND_NB);
+        for (int bet = 0; ok && bet < BET_NB; bet++) {
+            for (int card_nb = 0; ok && card_nb <= CARD_NB; card_nb++) {
+                ok = std::fread(slice.data(), sizeof(int), HAND_NB, f) == HAND_NB;
+                for (int hand_index = 0; hand_index < HAND_NB; hand_index++)
+                    P_[offset(bet, card_nb, hand_index)] = slice[hand_index];
+            }
+        }
+    }
     std::fclose(f);
-    if (got != need)
+    if (!ok)
         throw std::runtime_error("Could not read P table from " + path);
     return true;
 }
 
+bool ProbabilityTable::load_mmap(const std::string& path) {
+    // the file is bet-major, other layouts are copied in by load()
+    if (options_.layout != Layout::BetMajor)
+        return false;
+
+    MappedFile file;
+    if (!file.open(path, options_.populate, options_.access))
+        return false;
+    if (file.size() < HEADER_SIZE || std::memcmp(file.data(), "TTP0", 4) != 0)
+        return false;
+
+    u32 header[4];
+    std::memcpy(header, file.data() + 4, sizeof(header));
+    auto [version, bets, cards, hands] = header;
+    if (version != VERSION || bets != BET_NB || cards != CARD_NB+1 || hands != HAND_NB)
+        throw std::runtime_error("P table dim/version mismatch");
+    if (file.size() < HEADER_SIZE + TABLE_SIZE * sizeof(int))
+        throw std::runtime_error("Could not read P table from " + path);
+
+    // the 20 byte header keeps the payload 4-byte aligned; PROT_READ pages,
+    // every writer goes through make_writable() first
+    mapped_ = std::move(file);
+    owned_.reset();
+    P_ = reinterpret_cast<int*>(const_cast<std::byte*>(mapped_.data() + HEADER_SIZE));
+    return true;
+}
+
 void ProbabilityTable::save(const std::string& path) const {
+    if (quantized_) {
+        quant_.save(path);
+        return;
+    }
     FILE* f = std::fopen(path.c_str(), "wb");
     if (!f) throw std::runtime_error("Cannot open " + path);
     std::fwrite("TTP0", 1, 4, f);
@@ -106,7 +397,25 @@ void ProbabilityTable::save(const std::string& path) const {
     std::fwrite(&bets, 4, 1, f);
     std::fwrite(&cards, 4, 1, f);
     std::fwrite(&hands, 4, 1, f);
-    std::fwrite(P_, sizeof(int), BET_NB*(CARD_NB+1)*HAND_NB, f);
+    if (lazy_) {
+        for (int bet = 0; bet < BET_NB; bet++) {
+            for (int card_nb = 0; card_nb <= CARD_NB; card_nb++)
+                std::fwrite(lazy_slice(bet, card_nb), sizeof(int), HAND_NB, f);
+        }
+    }
+    else if (options_.layout == Layout::BetMajor) {
+        std::fwrite(P_, sizeof(int), TABLE_SIZE, f);
+    }
+    else {
+        std::vector<int> slice(HAND_NB);
+        for (int bet = 0; bet < BET_NB; bet++) {
+            for (int card_nb = 0; card_nb <= CARD_NB; card_nb++) {
+                for (int hand_index = 0; hand_index < HAND_NB; hand_index++)
+                    slice[hand_index] = P_[offset(bet, card_nb, hand_index)];
+                std::fwrite(slice.data(), sizeof(int), HAND_NB, f);
+            }
+        }
+    }
     std::fclose(f);
 }
 
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
 #include <vector>
 
 #include "../core/thai_poker.hpp"
 #include "combinatorics.hpp"
 #include "hand_table.hpp"
+#include "mapped_file.hpp"
+#include "quantized_table.hpp"
 
 namespace thai_poker {
 
@@ -13,23 +21,101 @@ class ProbabilityTable {
 public:
     static constexpr int VERSION = 1;
 
+    enum class LoadMode {
+        Read, // fread the table into memory owned by this object
+        Mmap, // serve it straight from the file's page cache
+        Quantized, // serve get_prob from a TTQ0 file, see quantized_table.hpp;
+                   // exact counts (get_comp) are not available
+        Lazy, // compute each (bet, card_nb) slice on its first query
+    };
+
+    enum class Layout {
+        BetMajor,  // [bet][card_nb][hand], the TTP0 file order
+        HandMajor, // [card_nb][hand][bet], one hand's bet profile is contiguous
+    };
+
+    struct Options {
+        LoadMode load_mode = LoadMode::Read; // Mmap needs Layout::BetMajor
+        Layout layout = Layout::BetMajor;
+        bool populate = false; // Mmap: fault in every page up front
+        MappedFile::Access access = MappedFile::Access::Normal;
+        int quantized_bits = 16; // Quantized: 16 or 8 bits per entry
+        bool persist_slices = true; // Lazy: read/write slices in a TTS0 file
+    };
+
     ProbabilityTable(const std::string&);
+    ProbabilityTable(const std::string&, Options);
     ProbabilityTable(const ProbabilityTable&) = delete;
     ProbabilityTable& operator=(const ProbabilityTable&) = delete;
+    ~ProbabilityTable();
 
     static ProbabilityTable& instance();
+    // options used by instance(); only effective before its first call
+    static void configure(Options options);
 
     [[nodiscard]] double get_prob(Bet b, int card_nb, Hand h) const;
     [[nodiscard]] int get_comp(Bet b, int card_nb, Hand h) const;
-    void build();
+    // the whole bet profile of a hand, out[bet] for every bet; a single
+    // contiguous 272 byte read with Layout::HandMajor
+    void get_comp_vector(int card_nb, Hand h, std::span<int, BET_NB> out) const;
+    void get_prob_vector(int card_nb, Hand h, std::span<float, BET_NB> out) const;
+    // threads == 0 uses every hardware thread; the result does not depend on it
+    void build(unsigned threads = 0);
+    // only the slices bet * (CARD_NB + 1) + card_nb listed, the others keep
+    // their counts; throws std::logic_error on a quantized or lazy table
+    void build(unsigned threads, std::span<const int> slices);
+    // same table from superset_count.hpp, in seconds instead of minutes
+    void build_analytic(unsigned threads = 0);
     bool load(const std::string& path);
     void save(const std::string& path) const;
 
 private:
 
-    Comb24 comb_;
+    static constexpr std::size_t HEADER_SIZE = 4 + 4 * sizeof(u32);
+    static constexpr std::size_t SLICE_NB = std::size_t{BET_NB} * (CARD_NB+1);
+    static constexpr std::size_t TABLE_SIZE = SLICE_NB * HAND_NB;
+    // TTS0: header, one "present" byte per slice, then slices at fixed offsets
+    static constexpr std::size_t SLICE_FILE_DATA = HEADER_SIZE + SLICE_NB;
+
+    [[nodiscard]] std::size_t offset(int bet, int card_nb, int hand_index) const {
+        if (options_.layout == Layout::HandMajor)
+            return (static_cast<std::size_t>(card_nb) * HAND_NB + hand_index) * BET_NB + bet;
+        return (static_cast<std::size_t>(bet) * (CARD_NB+1) + card_nb) * HAND_NB + hand_index;
+    }
+    [[nodiscard]] int checked_index(int card_nb, Hand h) const;
+    [[nodiscard]] int comp_at(int bet, int card_nb, int hand_index) const {
+        if (lazy_)
+            return lazy_slice(bet, card_nb)[hand_index];
+        return P_[offset(bet, card_nb, hand_index)];
+    }
+    [[nodiscard]] const int* lazy_slice(int bet, int card_nb) const;
+    bool open_slice_file(const std::string& path);
+    void close_slice_file();
+
+    void build_slice(int bet, int card_nb, std::vector<int>& H);
+    // replaces the exact table by its quantized form
+    void quantize();
+    bool load_mmap(const std::string& path);
+    // switches to owned storage before a build, drops any mapping; keep
+    // copies the mapped counts over
+    void make_writable(bool keep = false);
+
+    static Options& default_options();
+
+    Options options_;
+    static constexpr Comb24 const& comb_ = COMB24;
     HandTable const& table_;
-    static int P_[BET_NB][CARD_NB+1][HAND_NB];
+    std::unique_ptr<int[]> owned_;
+    MappedFile mapped_;
+    int* P_ = nullptr; // laid out as options_.layout, into owned_ or mapped_
+    QuantizedTable quant_;
+    bool quantized_ = false;
+
+    bool lazy_ = false;
+    mutable std::array<std::atomic<const int*>, SLICE_NB> lazy_slices_{};
+    mutable std::array<std::unique_ptr<int[]>, SLICE_NB> lazy_owned_;
+    mutable std::mutex lazy_mutex_;
+    std::FILE* slice_file_ = nullptr;
 };
 
 
@@ -0,0 +1,141 @@
+#include "quantized_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "../core/parallel.hpp"
+#include "hand_table.hpp"
+#include "probability_table.hpp"
+
+namespace thai_poker {
+
+void QuantizedTable::init(int bits) {
+    if (bits != 8 && bits != 16)
+        throw std::invalid_argument("QuantizedTable: bits must be 8 or 16");
+    bits_ = bits;
+    q16_.clear();
+    q8_.clear();
+    if (bits == 16)
+        q16_.resize(TABLE_SIZE);
+    else
+        q8_.resize(TABLE_SIZE);
+}
+
+void QuantizedTable::set_scales(std::vector<float> scales) {
+    scale_ = std::move(scales);
+    step_.resize(SLICE_NB);
+    const double qmax = (1U << bits_) - 1;
+    for (std::size_t slice = 0; slice < SLICE_NB; slice++)
+        step_[slice] = scale_[slice] / qmax;
+}
+
+QuantizedTable QuantizedTable::from(ProbabilityTable const& table, int bits, unsigned threads) {
+    HandTable const& hands = HandTable::instance();
+    QuantizedTable quant;
+    quant.init(bits);
+
+    const double qmax = (1U << bits) - 1;
+    std::vector<float> scales(SLICE_NB);
+    parallel_for(BET_NB, threads, [&](int bet, unsigned) {
+        std::vector<double> prob(HAND_NB);
+        for (int card_nb = 0; card_nb <= CARD_NB; card_nb++) {
+            double max_p = 0;
+            for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
+                Hand hand = hands.from_index(hand_index);
+                prob[hand_index] = popcount(hand) <= card_nb
+                    ? table.get_prob(static_cast<Bet>(bet), card_nb, hand) : 0.0;
+                max_p = std::max(max_p, prob[hand_index]);
+            }
+
+            // round the scale up so that no entry exceeds qmax
+            float scale = static_cast<float>(max_p);
+            if (scale < max_p)
+                scale = std::nextafter(scale, std::numeric_limits<float>::infinity());
+
+            const std::size_t slice = static_cast<std::size_t>(bet) * (CARD_NB+1) + card_nb;
+            scales[slice] = scale;
+            for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
+                const double q = scale > 0 ? std::round(prob[hand_index] / scale * qmax) : 0.0;
+                const std::size_t at = slice * HAND_NB + hand_index;
+                if (bits == 16)
+                    quant.q16_[at] = static_cast<std::uint16_t>(std::min(q, qmax));
+                else
+                    quant.q8_[at] = static_cast<std::uint8_t>(std::min(q, qmax));
+            }
+        }
+    });
+
+    quant.set_scales(std::move(scales));
+    return quant;
+}
+
+double QuantizedTable::max_error() const {
+    double worst = 0;
+    for (double step : step_)
+        worst = std::max(worst, step / 2);
+    return worst;
+}
+
+std::size_t QuantizedTable::memory_bytes() const {
+    return q16_.size() * sizeof(std::uint16_t) + q8_.size() + scale_.size() * sizeof(float);
+}
+
+bool QuantizedTable::load(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char magic[4];
+    if (std::fread(magic, 1, 4, f) != 4 || std::memcmp(magic, "TTQ0", 4) != 0) {
+        std::fclose(f);
+        return false;
+    }
+
+    u32 version=0, bets=0, cards=0, hands=0, bits=0;
+    std::fread(&version, 4, 1, f);
+    std::fread(&bets, 4, 1, f);
+    std::fread(&cards, 4, 1, f);
+    std::fread(&hands, 4, 1, f);
+    std::fread(&bits, 4, 1, f);
+    if (version != VERSION || bets != BET_NB || cards != CARD_NB+1 || hands != HAND_NB ||
+        (bits != 8 && bits != 16)) {
+        std::fclose(f);
+        throw std::runtime_error("Q table dim/version mismatch");
+    }
+
+    init(static_cast<int>(bits));
+    std::vector<float> scales(SLICE_NB);
+    bool ok = std::fread(scales.data(), sizeof(float), SLICE_NB, f) == SLICE_NB;
+    if (bits == 16)
+        ok = ok && std::fread(q16_.data(), sizeof(std::uint16_t), TABLE_SIZE, f) == TABLE_SIZE;
+    else
+        ok = ok && std::fread(q8_.data(), 1, TABLE_SIZE, f) == TABLE_SIZE;
+    std::fclose(f);
+    if (!ok)
+        throw std::runtime_error("Could not read Q table from " + path);
+
+    set_scales(std::move(scales));
+    return true;
+}
+
+void QuantizedTable::save(const std::string& path) const {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("Cannot open " + path);
+    std::fwrite("TTQ0", 1, 4, f);
+    u32 version = VERSION, bets = BET_NB, cards = CARD_NB+1, hands = HAND_NB, bits = bits_;
+    std::fwrite(&version, 4, 1, f);
+    std::fwrite(&bets, 4, 1, f);
+    std::fwrite(&cards, 4, 1, f);
+    std::fwrite(&hands, 4, 1, f);
+    std::fwrite(&bits, 4, 1, f);
+    std::fwrite(scale_.data(), sizeof(float), SLICE_NB, f);
+    if (bits_ == 16)
+        std::fwrite(q16_.data(), sizeof(std::uint16_t), TABLE_SIZE, f);
+    else
+        std::fwrite(q8_.data(), 1, TABLE_SIZE, f);
+    std::fclose(f);
+}
+
+} // namespace thai_poker
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../core/thai_poker.hpp"
+
+namespace thai_poker {
+
+class ProbabilityTable;
+
+// Probabilities of the TTP0 table stored as 16 or 8 bit fixed point with
+// one float scale per (bet, card_nb) slice: p ~ q * scale / (2^bits - 1),
+// scale being the slice maximum. Rounding to nearest bounds the error by
+//     |p - p~| <= scale / (2 * (2^bits - 1)),
+// i.e. at most 7.7e-6 for 16 bits and 2.0e-3 for 8 bits, and much less on
+// slices of unlikely bets. Saved as TTQ0.bin.
+class QuantizedTable {
+public:
+    static constexpr int VERSION = 1;
+
+    QuantizedTable() = default;
+
+    // converter from the exact table; bits is 8 or 16
+    [[nodiscard]] static QuantizedTable from(ProbabilityTable const& table, int bits, unsigned threads = 0);
+
+    [[nodiscard]] double get_prob(Bet b, int card_nb, int hand_index) const {
+        const std::size_t slice = static_cast<std::size_t>(to_i(b)) * (CARD_NB+1) + card_nb;
+        const std::size_t at = slice * HAND_NB + hand_index;
+        const unsigned q = bits_ == 16 ? q16_[at] : q8_[at];
+        return q * step_[slice];
+    }
+
+    [[nodiscard]] int bits() const { return bits_; }
+    // the bound above, maximized over all slices
+    [[nodiscard]] double max_error() const;
+    [[nodiscard]] std::size_t memory_bytes() const;
+
+    bool load(const std::string& path);
+    void save(const std::string& path) const;
+
+private:
+    static constexpr std::size_t SLICE_NB = std::size_t{BET_NB} * (CARD_NB+1);
+    static constexpr std::size_t TABLE_SIZE = SLICE_NB * HAND_NB;
+
+    void init(int bits);
+    void set_scales(std::vector<float> scales);
+
+    int bits_ = 0;
+    std::vector<float> scale_;
+    std::vector<double> step_; // scale_ / (2^bits - 1)
+    std::vector<std::uint16_t> q16_;
+    std::vector<std::uint8_t> q8_;
+};
+
+} // namespace thai_poker
@@ -0,0 +1,90 @@
+#include "subset_sum.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "../core/simd.hpp"
+
+namespace thai_poker {
+
+namespace {
+
+constexpr int BLOCK_BITS = 12; // 4096 ints = 16 KB, stays in L1
+
+// Transforms bits [b, b+3) of every 8*s chunk in [a, a+len), s = 1 << b.
+// The eight strided streams are independent, so the loop over i vectorizes.
+THAI_SIMD_CLONES
+void radix8(int* a, std::size_t len, std::size_t s) {
+    for (std::size_t base = 0; base < len; base += 8 * s) {
+        int* p = a + base;
+        for (std::size_t i = 0; i < s; i++) {
+            int x0 = p[i],         x1 = p[i + s],     x2 = p[i + 2 * s], x3 = p[i + 3 * s];
+            int x4 = p[i + 4 * s], x5 = p[i + 5 * s], x6 = p[i + 6 * s], x7 = p[i + 7 * s];
+            x0 += x1; x2 += x3; x4 += x5; x6 += x7;
+            x0 += x2; x1 += x3; x4 += x6; x5 += x7;
+            x0 += x4; x1 += x5; x2 += x6; x3 += x7;
+            p[i]         = x0; p[i + s]     = x1; p[i + 2 * s] = x2; p[i + 3 * s] = x3;
+            p[i + 4 * s] = x4; p[i + 5 * s] = x5; p[i + 6 * s] = x6;
+        }
+    }
+}
+
+THAI_SIMD_CLONES
+void radix4(int* a, std::size_t len, std::size_t s) {
+    for (std::size_t base = 0; base < len; base += 4 * s) {
+        int* p = a + base;
+        for (std::size_t i = 0; i < s; i++) {
+            int x0 = p[i], x1 = p[i + s], x2 = p[i + 2 * s], x3 = p[i + 3 * s];
+            x0 += x1; x2 += x3;
+            x0 += x2; x1 += x3;
+            p[i] = x0; p[i + s] = x1; p[i + 2 * s] = x2;
+        }
+    }
+}
+
+THAI_SIMD_CLONES
+void radix2(int* a, std::size_t len, std::size_t s) {
+    for (std::size_t base = 0; base < len; base += 2 * s) {
+        int* p = a + base;
+        for (std::size_t i = 0; i < s; i++)
+            p[i] += p[i + s];
+    }
+}
+
+// bits [lo, hi) over [a, a+len), up to three bits per sweep
+void transform_bits(int* a, std::size_t len, int lo, int hi) {
+    for (int b = lo; b < hi; b += 3) {
+        const std::size_t s = std::size_t{1} << b;
+        switch (std::min(3, hi - b)) {
+            case 3: radix8(a, len, s); break;
+            case 2: radix4(a, len, s); break;
+            default: radix2(a, len, s); break;
+        }
+    }
+}
+
+} // namespace
+
+void superset_sum(int* a, int bits) {
+    const int block_bits = std::min(bits, BLOCK_BITS);
+    const std::size_t len = std::size_t{1} << bits;
+    const std::size_t block = std::size_t{1} << block_bits;
+
+    for (std::size_t base = 0; base < len; base += block)
+        transform_bits(a + base, block, 0, block_bits);
+
+    transform_bits(a, len, block_bits, bits);
+}
+
+void superset_sum_naive(int* a, int bits) {
+    const std::size_t len = std::size_t{1} << bits;
+    for (int bit = 0; bit < bits; bit++) {
+        for (std::size_t mask = 0; mask < len; mask++) {
+            if ((mask >> bit & 1) == 0) {
+                a[mask] += a[mask ^ (std::size_t{1} << bit)];
+            }
+        }
+    }
+}
+
+} // namespace thai_poker
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace thai_poker {
+
+// In-place superset-sum (zeta) transform over a 2^bits array:
+// a[mask] becomes the sum of a[sup] over every sup that contains mask.
+//
+// Low bits are transformed block by block while the block sits in L1, the
+// remaining bits are done three at a time per pass over the array, so a
+// 24-bit transform streams memory 4 times instead of 24. Inner loops are
+// branch-free and compiled per instruction set (see core/simd.hpp).
+void superset_sum(int* a, int bits);
+
+// Reference implementation, one branchy pass per bit. Kept for tests and
+// benchmarks.
+void superset_sum_naive(int* a, int bits);
+
+} // namespace thai_poker
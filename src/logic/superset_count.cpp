@@ -0,0 +1,151 @@
+#include "superset_count.hpp"
+
+#include <stdexcept>
+
+#include "combinatorics.hpp"
+
+namespace thai_poker {
+
+namespace {
+
+constexpr Comb24 const& comb = COMB24;
+
+constexpr int PROFILE_BASE = 7; // a group holds at most 6 cards
+
+} // namespace
+
+SupersetCounter::SupersetCounter(Bet b) {
+    auto in = [b](Bet first, Bet last) { return first <= b && b <= last; };
+    if (in(Bet::HIGH_9, Bet::HIGH_A)) {
+        const int r = to_i(b) - to_i(Bet::HIGH_9);
+        add_clause({{ALL_RANK[r], 1}});
+    }
+    else if (in(Bet::PAIR_9, Bet::PAIR_A)) {
+        const int r = to_i(b) - to_i(Bet::PAIR_9);
+        add_clause({{ALL_RANK[r], 2}});
+    }
+    else if (b == Bet::LOW_STRAIGHT) {
+        add_clause({{ALL_RANK[0], 1}, {ALL_RANK[1], 1}, {ALL_RANK[2], 1},
+                    {ALL_RANK[3], 1}, {ALL_RANK[4], 1}});
+    }
+    else if (b == Bet::HIGH_STRAIGHT) {
+        add_clause({{ALL_RANK[1], 1}, {ALL_RANK[2], 1}, {ALL_RANK[3], 1},
+                    {ALL_RANK[4], 1}, {ALL_RANK[5], 1}});
+    }
+    else if (in(Bet::THREE_9, Bet::THREE_A)) {
+        const int r = to_i(b) - to_i(Bet::THREE_9);
+        add_clause({{ALL_RANK[r], 3}});
+    }
+    else if (in(Bet::FULL_9T, Bet::FULL_AK)) {
+        const int idx = to_i(b) - to_i(Bet::FULL_9T);
+        const int three = idx / 5;
+        int two = idx % 5;
+        if (two >= three) two++;
+        add_clause({{ALL_RANK[three], 3}, {ALL_RANK[two], 2}});
+    }
+    else if (in(Bet::FLUSH_C, Bet::FLUSH_S)) {
+        const int s = to_i(b) - to_i(Bet::FLUSH_C);
+        add_clause({{ALL_SUIT[s], 5}});
+    }
+    else if (in(Bet::QUADS_9, Bet::QUADS_A)) {
+        const int r = to_i(b) - to_i(Bet::QUADS_9);
+        add_clause({{ALL_RANK[r], 4}});
+    }
+    else if (in(Bet::POKER_C, Bet::POKER_S)) {
+        // small or royal straight flush: both need T..K of the suit,
+        // plus the 9 or the A; inclusion-exclusion over the two
+        const int s = to_i(b) - to_i(Bet::POKER_C);
+        const Hand middle = SMALL_POKER[s] & ROYAL_POKER[s];
+        const Hand nine = SMALL_POKER[s] & ~middle;
+        const Hand ace = ROYAL_POKER[s] & ~middle;
+        add_clause({{middle, 4}, {nine, 1}});
+        add_clause({{middle, 4}, {ace, 1}});
+        add_clause({{middle, 4}, {nine, 1}, {ace, 1}}, -1);
+    }
+    else if (in(Bet::ROYAL_POKER_C, Bet::ROYAL_POKER_S)) {
+        const int s = to_i(b) - to_i(Bet::ROYAL_POKER_C);
+        add_clause({{ROYAL_POKER[s], 5}});
+    }
+    else {
+        throw std::out_of_range("bet");
+    }
+
+    int profiles = CARD_NB + 1;
+    for (size_t g = 0; g < groups_.size(); g++)
+        profiles *= PROFILE_BASE;
+    slot_.assign(profiles, -1);
+}
+
+int SupersetCounter::add_group(Hand group) {
+    for (size_t g = 0; g < groups_.size(); g++) {
+        if (groups_[g] == group)
+            return static_cast<int>(g);
+    }
+    groups_.push_back(group);
+    return static_cast<int>(groups_.size()) - 1;
+}
+
+void SupersetCounter::add_clause(std::vector<std::pair<Hand, int>> const& req, int sign) {
+    Clause clause{{}, sign};
+    for (auto [group, need] : req)
+        clause.req.push_back(Requirement{add_group(group), need});
+    clauses_.push_back(clause);
+}
+
+SupersetCounter::Counts const& SupersetCounter::counts(Hand h) {
+    int key = 0;
+    for (size_t g = groups_.size(); g-- > 0; )
+        key = key * PROFILE_BASE + popcount(h & groups_[g]);
+    key = key * (CARD_NB + 1) + popcount(h);
+
+    if (slot_[key] < 0) {
+        slot_[key] = static_cast<int>(memo_.size());
+        memo_.push_back(compute(h));
+    }
+    return memo_[slot_[key]];
+}
+
+SupersetCounter::Counts SupersetCounter::compute(Hand h) const {
+    const int in_hand = popcount(h);
+    std::array<long long, CARD_NB + 1> total{};
+
+    for (Clause const& clause : clauses_) {
+        // ways[j]: number of ways to add j cards from the clause's groups
+        // so that every requirement holds
+        std::array<long long, CARD_NB + 1> ways{};
+        ways[0] = 1;
+        int rest = CARD_NB - in_hand;
+        for (Requirement const& req : clause.req) {
+            const Hand group = groups_[req.group];
+            const int have = popcount(h & group);
+            const int free = popcount(group) - have;
+            rest -= free;
+
+            std::array<long long, CARD_NB + 1> next{};
+            for (int j = 0; j <= CARD_NB; j++) {
+                if (ways[j] == 0) continue;
+                for (int k = 0; k <= free && j + k <= CARD_NB; k++) {
+                    if (have + k >= req.need)
+                        next[j + k] += ways[j] * comb.get(free, k);
+                }
+            }
+            ways = next;
+        }
+
+        // the remaining cards come from outside the clause's groups
+        for (int card_nb = in_hand; card_nb <= CARD_NB; card_nb++) {
+            for (int j = 0; j <= card_nb - in_hand; j++) {
+                const int other = card_nb - in_hand - j;
+                if (ways[j] != 0 && other <= rest)
+                    total[card_nb] += clause.sign * ways[j] * comb.get(rest, other);
+            }
+        }
+    }
+
+    Counts counts{};
+    for (int card_nb = 0; card_nb <= CARD_NB; card_nb++)
+        counts[card_nb] = static_cast<int>(total[card_nb]);
+    return counts;
+}
+
+} // namespace thai_poker
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "../core/thai_poker.hpp"
+
+namespace thai_poker {
+
+// Counts decks D with h ⊆ D, |D| = card_nb that satisfy a bet, without
+// enumerating decks. Every bet is a conjunction (or, for POKER_x, a union
+// of conjunctions) of "|D ∩ group| >= need" over disjoint rank/suit groups,
+// so the count only depends on how many cards of each group h already holds
+// and is a product of binomials over the free cards of each group.
+//
+// Results are memoized by that profile, which makes a full slice cost one
+// lookup per hand. Not thread-safe; use one counter per worker.
+class SupersetCounter {
+public:
+    using Counts = std::array<int, CARD_NB + 1>;
+
+    explicit SupersetCounter(Bet b);
+
+    // counts(h)[card_nb] for every card_nb; zero when card_nb < |h|
+    [[nodiscard]] Counts const& counts(Hand h);
+    [[nodiscard]] int count(int card_nb, Hand h) { return counts(h)[card_nb]; }
+
+private:
+    struct Requirement {
+        int group;
+        int need;
+    };
+
+    struct Clause {
+        std::vector<Requirement> req;
+        int sign;
+    };
+
+    int add_group(Hand group);
+    void add_clause(std::vector<std::pair<Hand, int>> const& req, int sign = 1);
+    [[nodiscard]] Counts compute(Hand h) const;
+
+    std::vector<Hand> groups_;
+    std::vector<Clause> clauses_;
+    std::vector<int> slot_;
+    std::vector<Counts> memo_;
+};
+
+} // namespace thai_poker
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include "logic/canonical_table.hpp"
+#include "logic/probability_table.hpp"
+using namespace thai_poker;
+
+TEST(CanonicalTable, SuitPermutations) {
+    Hand hand = (1U << make_card(Suit::SUIT_C, Rank::RANK_9)) |
+                (1U << make_card(Suit::SUIT_C, Rank::RANK_A)) |
+                (1U << make_card(Suit::SUIT_H, Rank::RANK_Q));
+
+    for (int perm = 0; perm < SUIT_PERM_NB; perm++) {
+        Hand p = permute_suits(hand, perm);
+        EXPECT_EQ(popcount(p), popcount(hand));
+        for (int bet = 0; bet < BET_NB; bet++) {
+            Bet b = static_cast<Bet>(bet);
+            EXPECT_EQ(satisfies_bet(hand, b), satisfies_bet(p, permute_bet(b, perm)));
+        }
+    }
+}
+
+TEST(CanonicalTable, Classes) {
+    HandTable& hand_table = HandTable::instance();
+    EXPECT_LT(hand_table.canonical_nb(), HAND_NB / 15);
+
+    for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
+        Hand hand = hand_table.from_index(hand_index);
+        auto [canonical_index, perm] = hand_table.to_canonical(hand);
+        ASSERT_EQ(permute_suits(hand, perm), hand_table.from_canonical(canonical_index));
+    }
+}
+
+TEST(CanonicalTable, MatchesProbabilityTable) {
+    ProbabilityTable& prob_table = ProbabilityTable::instance();
+    CanonicalProbabilityTable& canonical = CanonicalProbabilityTable::instance();
+    HandTable& hand_table = HandTable::instance();
+
+    for (int hand_index = 0; hand_index < HAND_NB; hand_index += 13) {
+        Hand hand = hand_table.from_index(hand_index);
+        for (int bet = 0; bet < BET_NB; bet++) {
+            for (int card_nb = 0; card_nb <= CARD_NB; card_nb++) {
+                ASSERT_EQ(canonical.get_comp(static_cast<Bet>(bet), card_nb, hand),
+                          prob_table.get_comp(static_cast<Bet>(bet), card_nb, hand));
+            }
+        }
+    }
+}
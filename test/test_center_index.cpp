@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "ai/center_index.hpp"
+#include "test_fixtures.hpp"
+using namespace thai_poker;
+
+TEST(CenterIndex, ExactMatchesBruteForce) {
+    std::mt19937 rng(2137);
+    const std::vector<Profile> centers = test::make_profiles(1500, 12, 3000, 40, rng);
+    std::vector<Profile> queries = test::make_profiles(300, 12, 3000, 0, rng);
+    // centers themselves, duplicated ones included, hit a tie at distance 0
+    for (int i = 0; i < 60; i++)
+        queries.push_back(centers[i]);
+
+    const CenterBlocks all(centers);
+    const ProfileRows rows(queries);
+    for (int groups : {0, 1, 7, 2000}) {
+        const CenterIndex index(centers, groups);
+        EXPECT_EQ(index.size(), static_cast<int>(centers.size()));
+        for (int q = 0; q < rows.size(); q++) {
+            float best, second, distance;
+            const int want = nearest_center(rows.row(q), all, best, second);
+            EXPECT_EQ(index.nearest(rows.row(q), distance), want) << "groups " << groups << " query " << q;
+            EXPECT_EQ(distance, best);
+        }
+    }
+}
+
+TEST(CenterIndex, ProbesReturnACenter) {
+    std::mt19937 rng(7);
+    const std::vector<Profile> centers = test::make_profiles(800, 10, 3000, 0, rng);
+    const std::vector<Profile> queries = test::make_profiles(100, 10, 3000, 0, rng);
+    const CenterIndex index(centers);
+    const ProfileRows rows(queries);
+    for (int q = 0; q < rows.size(); q++) {
+        float exact, probed;
+        (void) index.nearest(rows.row(q), exact);
+        const int id = index.nearest(rows.row(q), probed, 1);
+        ASSERT_GE(id, 0);
+        ASSERT_LT(id, index.size());
+        EXPECT_GE(probed, exact);
+        EXPECT_FLOAT_EQ(probed, static_cast<float>(l1_distance(queries[q], centers[id])));
+        // probing every group is the exact search
+        EXPECT_EQ(index.nearest(queries[q], probed, index.group_nb()), index.nearest(queries[q], exact));
+    }
+}
+
+TEST(CenterIndex, Empty) {
+    const CenterIndex index(std::vector<Profile>{});
+    float distance;
+    EXPECT_EQ(index.group_nb(), 0);
+    EXPECT_EQ(index.nearest(Profile{}, distance), -1);
+}
@@ -0,0 +1,271 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <map>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "ai/cluster_sampler.hpp"
+#include "core/parallel.hpp"
+#include "test_fixtures.hpp"
+
+using namespace thai_poker;
+
+TEST(ClusterSamplerTest, DrawsHandsWithTheirBlock) {
+    std::mt19937 gen(4);
+    ClusterSet clusters;
+    ClusterData data = test::make_cluster(4, 50, 5000, gen);
+    clusters.set(4, 5, data);
+    clusters.set(5, 3, test::make_cluster(5, 1, 10, gen));
+
+    ClusterSampler sampler(clusters);
+    EXPECT_EQ(sampler.size(4, 5), 5000u);
+    EXPECT_EQ(sampler.size(5, 3), 10u);
+    EXPECT_EQ(sampler.size(4, 4), 0u);
+
+    std::map<int, u32> position;
+    for (u32 i = 0; i < data.hands.size(); i++)
+        position[static_cast<int>(data.hands[i])] = i;
+
+    CounterRng rng(1, 2);
+    std::map<int, int> seen;
+    constexpr int DRAWS = 500000;
+    for (int i = 0; i < DRAWS; i++) {
+        ClusterSampler::Slot s = sampler.draw(4, 5, rng);
+        ASSERT_TRUE(position.contains(s.hand_index()));
+        const u32 at = position[s.hand_index()];
+        ASSERT_GE(at, data.offsets[s.block()]);
+        ASSERT_LT(at, data.offsets[s.block() + 1]);
+        ASSERT_EQ(s.hand(), HandTable::unrank(s.hand_index()));
+        seen[s.hand_index()]++;
+
+        EXPECT_EQ(sampler.draw(5, 3, rng).block(), 0);
+    }
+
+    // every hand is equally likely: 100 expected hits each
+    ASSERT_EQ(seen.size(), 5000u);
+    double chi2 = 0;
+    for (auto [hand, hits] : seen)
+        chi2 += (hits - 100.0) * (hits - 100.0) / 100.0;
+    EXPECT_LT(std::abs(chi2 - 4999) / std::sqrt(2 * 4999.0), 5.0);
+}
+
+TEST(ClusterSamplerTest, UniformBelow) {
+    std::mt19937_64 rng(3);
+    int hits[7] = {};
+    for (int i = 0; i < 70000; i++) {
+        const u32 x = uniform_below(rng, 7);
+        ASSERT_LT(x, 7u);
+        hits[x]++;
+    }
+    for (int h : hits)
+        EXPECT_NEAR(h, 10000, 500);
+    EXPECT_EQ(uniform_below(rng, 1), 0u);
+}
+
+TEST(ClusterSamplerTest, PairMatchesRejection) {
+    ClusterSet clusters;
+    clusters.set(1, 2, test::complete_cluster(1, 3));
+    clusters.set(2, 1, test::complete_cluster(2, 5));
+    ClusterSampler sampler(clusters);
+    ASSERT_TRUE(sampler.complete(1, 2));
+    ASSERT_TRUE(sampler.complete(2, 1));
+
+    // 24 * C(23, 2) disjoint pairs, about 330 draws each
+    constexpr int DRAWS = 2000000;
+    std::map<std::pair<Hand, Hand>, std::pair<int, int>> hits;
+    CounterRng exact_rng(5, 0), reject_rng(5, 1);
+    for (int i = 0; i < DRAWS; i++) {
+        ClusterSampler::Pair p = sampler.draw_pair(1, 2, exact_rng);
+        ASSERT_EQ(p.h1.hand() & p.h2.hand(), 0u);
+        ASSERT_EQ(popcount(p.h2.hand()), 2);
+        ASSERT_EQ(p.h2.hand_index(), HandTable::rank(p.h2.hand()));
+        ASSERT_EQ(p.h2.block(), p.h2.hand_index() % 5);
+        ASSERT_EQ(p.h1.block(), p.h1.hand_index() % 3);
+        hits[{p.h1.hand(), p.h2.hand()}].first++;
+
+        ClusterSampler::Slot s1, s2;
+        do {
+            s1 = sampler.draw(1, 2, reject_rng);
+            s2 = sampler.draw(2, 1, reject_rng);
+        } while (s1.hand() & s2.hand());
+        hits[{s1.hand(), s2.hand()}].second++;
+    }
+    ASSERT_EQ(hits.size(), 24u * 253u);
+
+    // two-sample chi-square with hits.size() - 1 degrees of freedom
+    double chi2 = 0;
+    for (auto const& [pair, n] : hits)
+        chi2 += double(n.first - n.second) * (n.first - n.second) / (n.first + n.second);
+    const double df = static_cast<double>(hits.size() - 1);
+    EXPECT_LT(std::abs(chi2 - df) / std::sqrt(2 * df), 5.0);
+}
+
+TEST(ClusterSamplerTest, SixSixPairMatchesRejection) {
+    ClusterSet clusters;
+    clusters.set(6, 6, test::complete_cluster(6, 5));
+    ClusterSampler sampler(clusters);
+
+    // joint blocks and the cards of h2 relative to h1's lowest card
+    constexpr int DRAWS = 500000;
+    std::map<int, std::pair<int, int>> hits;
+    auto key = [](ClusterSampler::Slot s1, ClusterSampler::Slot s2, int card) {
+        const int shift = std::countr_zero(s1.hand());
+        const bool has = (s2.hand() >> ((shift + card) % CARD_NB)) & 1;
+        return (s1.block() * 5 + s2.block()) * CARD_NB * 2 + card * 2 + has;
+    };
+    CounterRng exact_rng(6, 0), reject_rng(6, 1);
+    for (int i = 0; i < DRAWS; i++) {
+        ClusterSampler::Pair p = sampler.draw_pair(6, 6, exact_rng);
+        ASSERT_EQ(p.h1.hand() & p.h2.hand(), 0u);
+        ASSERT_EQ(p.h2.block(), p.h2.hand_index() % 5);
+        ClusterSampler::Slot s1, s2;
+        do {
+            s1 = sampler.draw(6, 6, reject_rng);
+            s2 = sampler.draw(6, 6, reject_rng);
+        } while (s1.hand() & s2.hand());
+        const int card = i % CARD_NB;
+        hits[key(p.h1, p.h2, card)].first++;
+        hits[key(s1, s2, card)].second++;
+    }
+
+    double chi2 = 0;
+    for (auto const& [k, n] : hits)
+        chi2 += double(n.first - n.second) * (n.first - n.second) / (n.first + n.second);
+    const double df = static_cast<double>(hits.size() - 1);
+    EXPECT_LT(std::abs(chi2 - df) / std::sqrt(2 * df), 5.0);
+}
+
+TEST(ClusterSamplerTest, IncompletePairFallsBack) {
+    ClusterSet clusters;
+    ClusterData partial = test::complete_cluster(3, 4);
+    partial.hands.pop_back();
+    partial.offsets.back()--;
+    clusters.set(3, 3, std::move(partial));
+    ClusterSampler sampler(clusters);
+    EXPECT_FALSE(sampler.complete(3, 3));
+
+    CounterRng rng(9, 0);
+    for (int i = 0; i < 10000; i++) {
+        ClusterSampler::Pair p = sampler.draw_pair(3, 3, rng);
+        ASSERT_EQ(p.h1.hand() & p.h2.hand(), 0u);
+        ASSERT_EQ(popcount(p.h2.hand()), 3);
+    }
+}
+
+TEST(ClusterSamplerTest, FindsRarePairs) {
+    // 6-card hands with card 0 but one, against card 0 alone: a single
+    // disjoint pair, which redrawing both hands all but never finds
+    ClusterData first, second;
+    first.offsets = {0};
+    second.offsets = {0, 1};
+    for (int i = 0; i < HAND_NB; i++) {
+        const Hand hand = HandTable::unrank(i);
+        if (popcount(hand) == 6 && ((hand & 1) || hand == 0b111111000u))
+            first.hands.push_back(static_cast<u32>(i));
+    }
+    first.offsets.push_back(static_cast<u32>(first.hands.size()));
+    first.centers.assign(BET_NB, 0.0f);
+    second.hands.push_back(static_cast<u32>(HandTable::rank(1)));
+    second.centers.assign(BET_NB, 0.0f);
+    ClusterSet clusters;
+    clusters.set(6, 1, first);
+    clusters.set(1, 6, second);
+    clusters.set(1, 1, second);
+    ClusterSampler sampler(clusters);
+
+    CounterRng rng(3, 0);
+    for (int i = 0; i < 20; i++) {
+        ClusterSampler::Pair p = sampler.draw_pair(6, 1, rng);
+        EXPECT_EQ(p.h1.hand(), 0b111111000u);
+        EXPECT_EQ(p.h2.hand(), 1u);
+    }
+    // and card 0 against itself, none
+    EXPECT_THROW((void) sampler.draw_pair(1, 1, rng), std::domain_error);
+}
+
+TEST(ClusterSamplerTest, IncompletePairsAreExact) {
+    // 6-card hands with cards 0, 1 and 2, against those three cards alone,
+    // plus three hands missing some of them: 7 disjoint pairs in 3999, so
+    // most draws fall back, and each pair should come up 1/7 of the time
+    const Hand missing[] = {0b11111100u, 0b11111100000000u, 0b101111100u};
+    ClusterData first, second;
+    first.offsets = {0};
+    for (int i = 0; i < HAND_NB; i++) {
+        const Hand hand = HandTable::unrank(i);
+        if (popcount(hand) == 6 && (hand & 0b111u) == 0b111u)
+            first.hands.push_back(static_cast<u32>(i));
+    }
+    for (Hand hand : missing)
+        first.hands.push_back(static_cast<u32>(HandTable::rank(hand)));
+    first.offsets.push_back(static_cast<u32>(first.hands.size()));
+    first.centers.assign(BET_NB, 0.0f);
+    second.offsets = {0, 3};
+    for (Hand card : {1u, 2u, 4u})
+        second.hands.push_back(static_cast<u32>(HandTable::rank(card)));
+    second.centers.assign(BET_NB, 0.0f);
+    ClusterSet clusters;
+    clusters.set(6, 1, first);
+    clusters.set(1, 6, second);
+    ClusterSampler sampler(clusters);
+    ASSERT_FALSE(sampler.complete(1, 6));
+
+    constexpr int DRAWS = 14000;
+    std::map<std::pair<Hand, Hand>, int> hits;
+    CounterRng rng(5, 0);
+    for (int i = 0; i < DRAWS; i++) {
+        ClusterSampler::Pair p = sampler.draw_pair(6, 1, rng);
+        ASSERT_EQ(p.h1.hand() & p.h2.hand(), 0u);
+        hits[{p.h1.hand(), p.h2.hand()}]++;
+    }
+    ASSERT_EQ(hits.size(), 7u);
+    double chi2 = 0;
+    for (auto const& [pair, n] : hits)
+        chi2 += (n - DRAWS / 7.0) * (n - DRAWS / 7.0) / (DRAWS / 7.0);
+    // 6 degrees of freedom, p < 1e-4
+    EXPECT_LT(chi2, 27.9);
+}
+
+TEST(ClusterSamplerTest, StreamsReplayOnAnyThread) {
+    ClusterSet clusters;
+    clusters.set(3, 5, test::complete_cluster(3, 7));
+    clusters.set(5, 3, test::complete_cluster(5, 11));
+    ClusterSampler sampler(clusters);
+
+    constexpr int STREAMS = 8, DEALS = 5000;
+    std::vector<std::vector<GameSample>> serial(STREAMS, std::vector<GameSample>(DEALS));
+    for (int s = 0; s < STREAMS; s++)
+        SampleStream(sampler, 42, s).fill(3, 5, serial[s]);
+
+    // uneven batches on 4 threads
+    std::vector<std::vector<GameSample>> threaded(STREAMS, std::vector<GameSample>(DEALS));
+    parallel_for(STREAMS, 4, [&](int s, unsigned) {
+        SampleStream deals(sampler, 42, s);
+        std::span<GameSample> out(threaded[s]);
+        for (std::size_t done = 0, batch = 1; done < out.size(); done += batch, batch *= 3) {
+            batch = std::min(batch, out.size() - done);
+            deals.fill(3, 5, out.subspan(done, batch));
+        }
+    });
+
+    for (int s = 0; s < STREAMS; s++) {
+        for (int i = 0; i < DEALS; i++) {
+            GameSample const& a = serial[s][i];
+            GameSample const& b = threaded[s][i];
+            ASSERT_EQ(a.h1, b.h1);
+            ASSERT_EQ(a.h2, b.h2);
+            ASSERT_EQ(a.h1_block, b.h1_block);
+            ASSERT_EQ(a.h2_block, b.h2_block);
+            ASSERT_EQ(a.h1 & a.h2, 0u);
+            ASSERT_EQ(popcount(a.h1), 3);
+            ASSERT_EQ(popcount(a.h2), 5);
+        }
+    }
+    int same = 0;
+    for (int i = 0; i < DEALS; i++)
+        same += serial[0][i].h1 == serial[1][i].h1 && serial[0][i].h2 == serial[1][i].h2;
+    EXPECT_LT(same, 10);
+}
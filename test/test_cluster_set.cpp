@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "ai/cluster_set.hpp"
+#include "logic/hand_table.hpp"
+#include "test_fixtures.hpp"
+
+using namespace thai_poker;
+
+namespace {
+
+void expect_same(ClusterView const& v, ClusterData const& data) {
+    ASSERT_EQ(v.offsets.size(), data.offsets.size());
+    ASSERT_EQ(v.hands.size(), data.hands.size());
+    ASSERT_EQ(v.centers.size(), data.centers.size());
+    for (std::size_t i = 0; i < data.offsets.size(); i++) EXPECT_EQ(v.offsets[i], data.offsets[i]);
+    for (std::size_t i = 0; i < data.hands.size(); i++) EXPECT_EQ(v.hands[i], data.hands[i]);
+    for (std::size_t i = 0; i < data.centers.size(); i++) EXPECT_EQ(v.centers[i], data.centers[i]);
+}
+
+void expect_buckets(ClusterSet const& set, int opp_size, ClusterData const& data) {
+    for (std::size_t b = 0; b + 1 < data.offsets.size(); b++) {
+        for (u32 i = data.offsets[b]; i < data.offsets[b + 1]; i++)
+            EXPECT_EQ(set.bucket_of(opp_size, static_cast<int>(data.hands[i])), static_cast<int>(b));
+    }
+}
+
+} // namespace
+
+TEST(ClusterSetTest, SaveAndMap) {
+    std::mt19937 rng(7);
+    ClusterSet set;
+    ClusterData a = test::make_cluster(3, 5, 40, rng), b = test::make_cluster(5, 1, 3, rng);
+    set.set(3, 5, a);
+    set.set(5, 3, b);
+
+    const std::string path = std::string(DATA_DIR) + "/HCL1_test.bin";
+    set.save(path);
+
+    ClusterSet loaded;
+    ASSERT_TRUE(loaded.load(path));
+    EXPECT_TRUE(loaded.mapped());
+    expect_same(loaded.at(3, 5), a);
+    expect_same(loaded.at(5, 3), b);
+    EXPECT_EQ(loaded.at(3, 5).block_nb(), 5);
+    EXPECT_EQ(loaded.at(2, 2).block_nb(), 0);
+    EXPECT_TRUE(loaded.at(2, 2).hands.empty());
+    expect_buckets(loaded, 5, a);
+    expect_buckets(loaded, 3, b);
+    EXPECT_EQ(loaded.bucket_of(5, static_cast<int>(b.hands[0])), ClusterSet::NO_BUCKET);
+
+    // replacing a cluster copies the others out of the mapping
+    ClusterData c = test::make_cluster(2, 2, 10, rng);
+    loaded.set(2, 2, c);
+    EXPECT_FALSE(loaded.mapped());
+    expect_same(loaded.at(3, 5), a);
+    expect_same(loaded.at(2, 2), c);
+    expect_buckets(loaded, 5, a);
+    expect_buckets(loaded, 2, c);
+
+    // and replacing it again forgets the old hands
+    ClusterData d = test::make_cluster(2, 1, 5, rng);
+    loaded.set(2, 2, d);
+    expect_buckets(loaded, 2, d);
+    for (u32 hand : c.hands) {
+        if (std::find(d.hands.begin(), d.hands.end(), hand) == d.hands.end()) {
+            EXPECT_EQ(loaded.bucket_of(2, static_cast<int>(hand)), ClusterSet::NO_BUCKET);
+        }
+    }
+
+    std::remove(path.c_str());
+    EXPECT_FALSE(loaded.load(path));
+}
+
+TEST(ClusterSetTest, RejectsBadFiles) {
+    std::mt19937 rng(11);
+    ClusterSet set;
+    set.set(4, 4, test::make_cluster(4, 3, 20, rng));
+    EXPECT_THROW(set.set(4, 5, ClusterData{{0, 2}, {1}, std::vector<float>(BET_NB)}), std::invalid_argument);
+    // hand index 1 is a single card
+    EXPECT_THROW(set.set(4, 5, ClusterData{{0, 1}, {1}, std::vector<float>(BET_NB)}), std::invalid_argument);
+
+    const std::string path = std::string(DATA_DIR) + "/HCL1_test.bin";
+    set.save(path);
+
+    // cut into the last cluster's payload
+    FILE* f = std::fopen(path.c_str(), "rb");
+    std::vector<char> bytes;
+    for (int ch; (ch = std::fgetc(f)) != EOF;) bytes.push_back(static_cast<char>(ch));
+    std::fclose(f);
+    f = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size() - 8, f);
+    std::fclose(f);
+
+    ClusterSet loaded;
+    EXPECT_THROW(loaded.load(path), std::runtime_error);
+
+    // block offsets going back fail the load, a bucket past the cluster's
+    // blocks or a hand of the wrong size only validate()
+    constexpr std::size_t HEADER = 20, BUCKETS_AT = HEADER + ClusterSet::CLUSTER_NB * 16;
+    ClusterView const& v = set.at(4, 4);
+    auto write_patched = [&](std::size_t at, auto value) {
+        std::vector<char> patched = bytes;
+        std::memcpy(patched.data() + at, &value, sizeof(value));
+        f = std::fopen(path.c_str(), "wb");
+        std::fwrite(patched.data(), 1, patched.size(), f);
+        std::fclose(f);
+    };
+    std::uint64_t at;
+    std::memcpy(&at, bytes.data() + HEADER + (4 * (CARD_NB + 1) + 4) * 16 + 8, 8);
+    write_patched(at + 4, v.offsets[2] + 1);
+    EXPECT_THROW(loaded.load(path), std::runtime_error);
+    write_patched(BUCKETS_AT + (4 * std::size_t(HAND_NB) + v.hands[0]) * 2, static_cast<std::uint16_t>(3));
+    ASSERT_TRUE(loaded.load(path));
+    EXPECT_THROW(loaded.validate(), std::runtime_error);
+    EXPECT_THROW(loaded.set(1, 1, ClusterData{}), std::runtime_error);
+    write_patched(at + (v.offsets.size() + 1) * 4, u32{1});
+    ASSERT_TRUE(loaded.load(path));
+    EXPECT_THROW(loaded.validate(), std::runtime_error);
+    write_patched(0, bytes[0]);
+    EXPECT_TRUE(loaded.load(path));
+    EXPECT_NO_THROW(loaded.validate());
+    std::remove(path.c_str());
+}
+
+TEST(ClusterSetTest, ConvertsHcl0) {
+    std::mt19937 rng(13);
+    ClusterData a = test::make_cluster(2, 4, 30, rng);
+
+    // the HCL0 layout of the first HandCluster::save
+    const std::string path = std::string(DATA_DIR) + "/HCL0_test.bin";
+    FILE* f = std::fopen(path.c_str(), "wb");
+    const u32 header[3] = {1, HAND_SZ + 1, CARD_NB + 1};
+    std::fwrite("HCL0", 1, 4, f);
+    std::fwrite(header, 4, 3, f);
+    auto write_point = [&](std::span<const float> profile, int hand_index, int opp_size) {
+        for (float x : profile) {
+            const double d = x;
+            std::fwrite(&d, sizeof(d), 1, f);
+        }
+        for (int i = static_cast<int>(profile.size()); i < BET_NB; i++) {
+            const double d = 0;
+            std::fwrite(&d, sizeof(d), 1, f);
+        }
+        std::fwrite(&hand_index, sizeof(int), 1, f);
+        std::fwrite(&opp_size, sizeof(int), 1, f);
+    };
+    for (int hand_size = 0; hand_size <= HAND_SZ; hand_size++) {
+        for (int opp_size = 0; opp_size <= CARD_NB; opp_size++) {
+            const bool filled = hand_size == 2 && opp_size == 6;
+            const u32 blocks = filled ? 4 : 0;
+            std::fwrite(&blocks, 4, 1, f);
+            for (u32 b = 0; b < blocks; b++) {
+                const u32 n = a.offsets[b + 1] - a.offsets[b];
+                std::fwrite(&n, 4, 1, f);
+                for (u32 i = a.offsets[b]; i < a.offsets[b + 1]; i++)
+                    write_point({}, static_cast<int>(a.hands[i]), opp_size);
+            }
+            std::fwrite(&blocks, 4, 1, f);
+            for (u32 b = 0; b < blocks; b++) {
+                const int prefix = static_cast<int>(a.offsets[b + 1]);
+                std::fwrite(&prefix, sizeof(int), 1, f);
+            }
+            std::fwrite(&blocks, 4, 1, f);
+            for (u32 b = 0; b < blocks; b++)
+                write_point(std::span<const float>(a.centers).subspan(b * BET_NB, BET_NB), -1, -1);
+        }
+    }
+    std::fclose(f);
+
+    ClusterSet set;
+    ASSERT_TRUE(set.load_hcl0(path));
+    expect_same(set.at(2, 6), a);
+    expect_buckets(set, 6, a);
+    EXPECT_EQ(set.at(6, 2).block_nb(), 0);
+    std::remove(path.c_str());
+}
+
+TEST(ClusterSetTest, LoadsVersion1) {
+    std::mt19937 rng(17);
+    ClusterSet set;
+    ClusterData a = test::make_cluster(6, 3, 25, rng);
+    set.set(6, 4, a);
+
+    const std::string path = std::string(DATA_DIR) + "/HCL1_test.bin";
+    set.save(path);
+
+    // version 1 is version 2 without the bucket table
+    FILE* f = std::fopen(path.c_str(), "rb");
+    std::vector<char> bytes;
+    for (int ch; (ch = std::fgetc(f)) != EOF;) bytes.push_back(static_cast<char>(ch));
+    std::fclose(f);
+    constexpr std::size_t HEADER = 20, DIRECTORY = ClusterSet::CLUSTER_NB * 16;
+    constexpr std::size_t BUCKETS = ((CARD_NB + 1) * std::size_t(HAND_NB) * 2 + 3) / 4 * 4;
+    const u32 version = 1;
+    std::memcpy(bytes.data() + 4, &version, 4);
+    for (int c = 0; c < ClusterSet::CLUSTER_NB; c++) {
+        std::uint64_t at;
+        std::memcpy(&at, bytes.data() + HEADER + c * 16 + 8, 8);
+        at -= BUCKETS;
+        std::memcpy(bytes.data() + HEADER + c * 16 + 8, &at, 8);
+    }
+    bytes.erase(bytes.begin() + HEADER + DIRECTORY, bytes.begin() + HEADER + DIRECTORY + BUCKETS);
+    f = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size(), f);
+    std::fclose(f);
+
+    ClusterSet loaded;
+    ASSERT_TRUE(loaded.load(path));
+    expect_same(loaded.at(6, 4), a);
+    expect_buckets(loaded, 4, a);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "ai/cluster_set.hpp"
+#include "ai/kmeans.hpp"
+#include "logic/hand_table.hpp"
+
+namespace thai_poker::test {
+
+// integer profiles around well separated bases, like get_comp counts:
+// profile i belongs to group i % groups and is off its base by less than
+// spread, then dups copies of the first ones so ties come up
+inline std::vector<Profile> make_profiles(int n, int groups, int spread, int dups, std::mt19937& rng) {
+    std::vector<Profile> base(groups);
+    for (auto& b : base) {
+        for (double& x : b)
+            x = static_cast<double>(rng() % 100000);
+    }
+    std::vector<Profile> points(n);
+    for (int i = 0; i < n; i++) {
+        for (int bet = 0; bet < BET_NB; bet++)
+            points[i][bet] = base[i % groups][bet] + static_cast<double>(rng() % spread);
+    }
+    for (int i = 0; i < dups; i++)
+        points.push_back(points[i]);
+    return points;
+}
+
+// distinct random hands of hand_size cards over blocks of random sizes,
+// with random centers
+inline ClusterData make_cluster(int hand_size, int blocks, int hands, std::mt19937& rng) {
+    std::set<u32> used;
+    ClusterData data;
+    data.offsets.push_back(0);
+    for (int b = 0; b < blocks; b++) {
+        const int size = b + 1 == blocks ? hands : std::uniform_int_distribution<int>(1, hands - (blocks - b - 1))(rng);
+        hands -= size;
+        while (static_cast<int>(data.hands.size()) < static_cast<int>(data.offsets.back()) + size) {
+            const u32 hand = std::uniform_int_distribution<u32>(0, HAND_NB - 1)(rng);
+            if (popcount(HandTable::unrank(static_cast<int>(hand))) == hand_size && used.insert(hand).second)
+                data.hands.push_back(hand);
+        }
+        data.offsets.push_back(static_cast<u32>(data.hands.size()));
+    }
+    for (int i = 0; i < blocks * BET_NB; i++)
+        data.centers.push_back(std::uniform_real_distribution<float>(0, 1e6f)(rng));
+    return data;
+}
+
+// every hand of hand_size cards, hand index i in block i % blocks
+inline ClusterData complete_cluster(int hand_size, int blocks) {
+    std::vector<std::vector<u32>> by_block(blocks);
+    for (int i = 0; i < HAND_NB; i++) {
+        if (popcount(HandTable::unrank(i)) == hand_size)
+            by_block[i % blocks].push_back(static_cast<u32>(i));
+    }
+    ClusterData data;
+    data.offsets.push_back(0);
+    for (auto const& block : by_block) {
+        data.hands.insert(data.hands.end(), block.begin(), block.end());
+        data.offsets.push_back(static_cast<u32>(data.hands.size()));
+    }
+    data.centers.assign(std::size_t(blocks) * BET_NB, 0.0f);
+    return data;
+}
+
+} // namespace thai_poker::test
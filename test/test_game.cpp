@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <numeric>
+#include <random>
+
+#include "core/game.hpp"
+using namespace thai_poker;
+
+static_assert(initial_cards(2) == 3 && initial_cards(4) == 2 && initial_cards(10) == 1);
+static_assert(max_cards(2) == 6 && max_cards(4) == 5 && max_cards(7) == 3 && max_cards(10) == 2);
+
+TEST(Game, BiddingAndShowdown) {
+    std::array<Card, CARD_NB> deck;
+    std::iota(deck.begin(), deck.end(), 0);
+
+    GameState game(3, 1);
+    game.deal(deck);
+    EXPECT_EQ(game.hand(0), 0x3U);
+    EXPECT_EQ(game.hand(1), 0xCU);
+    EXPECT_EQ(game.table(), 0x3FU);
+    EXPECT_EQ(game.to_move(), 1);
+
+    EXPECT_FALSE(game.is_legal(Bet::CHECK));
+    game.play(Bet::PAIR_9);
+    EXPECT_EQ(game.to_move(), 2);
+    EXPECT_FALSE(game.is_legal(Bet::HIGH_A));
+    EXPECT_FALSE(game.is_legal(Bet::PAIR_9));
+    EXPECT_THROW(game.play(Bet::HIGH_A), std::invalid_argument);
+    game.play(Bet::PAIR_T);
+    EXPECT_EQ(game.to_move(), 0);
+    EXPECT_EQ(game.bid_nb(), 2);
+    EXPECT_EQ(game.last_bid(), Bet::PAIR_T);
+
+    // 9 9 9 9 T T are on the table, so player 0 checks a true pair of tens
+    game.play(Bet::CHECK);
+    EXPECT_TRUE(game.round_over());
+    EXPECT_EQ(game.loser(), 0);
+    EXPECT_EQ(game.cards(0), 3);
+    EXPECT_EQ(game.starter(), 0);
+
+    game.deal(deck);
+    game.play(Bet::QUADS_A);
+    game.play(Bet::CHECK);
+    EXPECT_EQ(game.loser(), 0);
+    EXPECT_EQ(game.cards(0), 4);
+}
+
+TEST(Game, Elimination) {
+    std::array<Card, CARD_NB> deck;
+    std::iota(deck.begin(), deck.end(), 0);
+
+    // player 1 keeps bidding royal pokers nobody has
+    GameState game(2, 1);
+    while (!game.game_over()) {
+        game.deal(deck);
+        EXPECT_EQ(game.to_move(), 1);
+        game.play(Bet::ROYAL_POKER_S);
+        EXPECT_FALSE(game.is_legal(Bet::ROYAL_POKER_S));
+        game.play(Bet::CHECK);
+        EXPECT_EQ(game.loser(), 1);
+    }
+    EXPECT_FALSE(game.alive(1));
+    EXPECT_EQ(game.winner(), 0);
+    EXPECT_EQ(game.cards(0), 3);
+    EXPECT_THROW(game.deal(deck), std::logic_error);
+}
+
+TEST(Game, RandomGamesFinish) {
+    std::mt19937_64 rng(2137);
+    for (int players = PLAYER_NB_MIN; players <= PLAYER_NB_MAX; players++) {
+        for (int rep = 0; rep < 100; rep++) {
+            GameState game(players);
+            int rounds = 0;
+            while (!game.game_over()) {
+                game.deal(rng);
+                int dealt = 0;
+                for (int p = 0; p < players; p++) {
+                    ASSERT_EQ(popcount(game.hand(p)), game.cards(p));
+                    ASSERT_LE(game.cards(p), game.max_cards());
+                    dealt += game.cards(p);
+                }
+                ASSERT_EQ(popcount(game.table()), dealt);
+
+                const GameState before = game;
+                while (!game.round_over()) {
+                    Bet bet = static_cast<Bet>(to_i(game.last_bid()) + 1);
+                    if (game.bid_nb() == 0) bet = Bet::HIGH_9;
+                    else if (rng() % 3 == 0) bet = Bet::CHECK;
+                    game.play(bet);
+                }
+                ASSERT_EQ(game.alive_nb() + (game.alive(game.loser()) ? 0 : 1), before.alive_nb());
+                ASSERT_TRUE(game.alive(game.starter()));
+                rounds++;
+            }
+            EXPECT_GE(rounds, players);
+            EXPECT_GE(game.winner(), 0);
+        }
+    }
+}
@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+
+#include "logic/hand_table.hpp"
+using namespace thai_poker;
+
+static_assert(HandTable::rank(0) == 0);
+static_assert(HandTable::unrank(HAND_NB - 1) == 0xFC0000);
+static_assert(HandTable::rank(0xFC0000) == HAND_NB - 1);
+
+TEST(HandTable, RankMatchesTable) {
+    HandTable& hand_table = HandTable::instance();
+    for (int idx = 0; idx < HAND_NB; idx++) {
+        Hand hand = hand_table.from_index(idx);
+        ASSERT_EQ(HandTable::rank(hand), idx);
+        ASSERT_EQ(HandTable::unrank(idx), hand);
+        ASSERT_EQ(hand_table.to_index(hand), idx);
+    }
+}
+
+TEST(HandTable, RankRejectsLargeHands) {
+    EXPECT_EQ(HandTable::rank(0x7F), -1);
+    EXPECT_EQ(HandTable::rank(0xFFFFFF), -1);
+    EXPECT_EQ(HandTable::rank(1U << CARD_NB), -1);
+}
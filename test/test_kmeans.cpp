@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "ai/kmeans.hpp"
+#include "ai/l1_kernel.hpp"
+#include "test_fixtures.hpp"
+using namespace thai_poker;
+
+TEST(KMeans, SameForAnyThreadCount) {
+    std::mt19937 rng(2137);
+    const auto points = test::make_profiles(5000, 40, 1000, 0, rng);
+    const std::vector<Profile> init(points.begin(), points.begin() + 40);
+
+    auto one = init;
+    auto many = init;
+    const KMeansResult r1 = kmeans(points, {}, one, KMeansOptions{5, 1});
+    const KMeansResult r4 = kmeans(points, {}, many, KMeansOptions{5, 4});
+    EXPECT_EQ(one, many);
+    EXPECT_EQ(r1.assignment, r4.assignment);
+    EXPECT_EQ(r1.error, r4.error);
+    EXPECT_EQ(r1.iterations, r4.iterations);
+}
+
+TEST(KMeans, AssignsNearestCenter) {
+    std::mt19937 rng(2137);
+    const auto points = test::make_profiles(2000, 20, 1000, 0, rng);
+    std::vector<Profile> centers(points.begin(), points.begin() + 20);
+
+    const KMeansResult r = kmeans(points, {}, centers, KMeansOptions{3});
+    double error = 0;
+    for (std::size_t i = 0; i < points.size(); i++) {
+        const double d = l1_distance(points[i], centers[r.assignment[i]]);
+        for (auto const& c : centers)
+            ASSERT_LE(d, l1_distance(points[i], c));
+        error += d;
+    }
+    EXPECT_NEAR(r.error, error, 1e-6 * error);
+}
+
+TEST(KMeans, AcceleratedMatchesLloyd) {
+    std::mt19937 rng(2137);
+    const auto points = test::make_profiles(6000, 30, 1000, 0, rng);
+    // a second center in a third of the groups, so that some keep moving
+    // between iterations
+    std::vector<Profile> init(points.begin(), points.begin() + 30);
+    for (int i = 0; i < 10; i++)
+        init.push_back(points[30 + i * 7]);
+
+    auto plain = init;
+    auto fast = init;
+    const KMeansResult rp = kmeans(points, {}, plain, KMeansOptions{6, 0, false});
+    const KMeansResult rf = kmeans(points, {}, fast, KMeansOptions{6, 0, true});
+    EXPECT_EQ(rp.assignment, rf.assignment);
+    EXPECT_EQ(plain, fast);
+    EXPECT_NEAR(rp.error, rf.error, 1e-9 * rp.error);
+    EXPECT_LT(rf.distances * 2, rp.distances);
+}
+
+TEST(KMeans, WeightsMatchDuplicates) {
+    std::mt19937 rng(2137);
+    const auto points = test::make_profiles(1000, 10, 1000, 0, rng);
+    std::vector<int> weights(points.size());
+    std::vector<Profile> copies;
+    for (std::size_t i = 0; i < points.size(); i++) {
+        weights[i] = 1 + static_cast<int>(rng() % 4);
+        copies.insert(copies.end(), weights[i], points[i]);
+    }
+    const std::vector<Profile> init(points.begin(), points.begin() + 10);
+
+    auto weighted = init;
+    auto duplicated = init;
+    const KMeansResult rw = kmeans(points, weights, weighted, KMeansOptions{4});
+    const KMeansResult rd = kmeans(copies, {}, duplicated, KMeansOptions{4});
+    EXPECT_EQ(weighted, duplicated);
+    EXPECT_NEAR(rw.error, rd.error, 1e-9 * rd.error);
+}
+
+TEST(KMeans, PlusPlusSeedsEveryGroup) {
+    std::mt19937 rng(2137);
+    const auto points = test::make_profiles(3000, 25, 1000, 0, rng);
+
+    CounterRng r1(7, 0), r4(7, 0);
+    const auto centers = kmeans_plus_plus(points, {}, 25, r1, 1);
+    EXPECT_EQ(centers, kmeans_plus_plus(points, {}, 25, r4, 4));
+    ASSERT_EQ(centers.size(), 25U);
+
+    // D^2 sampling lands in each of the far apart groups once, after which
+    // Lloyd has nothing left to move
+    auto refined = centers;
+    const KMeansResult r = kmeans(points, {}, refined, KMeansOptions{10});
+    EXPECT_TRUE(r.converged);
+    EXPECT_LE(r.iterations, 2);
+    std::vector<int> size(25);
+    for (int c : r.assignment)
+        size[c]++;
+    for (int s : size)
+        EXPECT_EQ(s, 3000 / 25);
+
+    // no more centers than distinct points
+    const std::vector<Profile> few(points.begin(), points.begin() + 3);
+    CounterRng r2(7, 0);
+    EXPECT_EQ(kmeans_plus_plus(few, {}, 10, r2).size(), 3U);
+}
+
+TEST(KMeans, EmptyCenterStaysPut) {
+    std::mt19937 rng(2137);
+    const auto points = test::make_profiles(500, 5, 1000, 0, rng);
+    std::vector<Profile> centers(points.begin(), points.begin() + 5);
+    Profile far;
+    far.fill(1e9);
+    centers.push_back(far);
+
+    const KMeansResult r = kmeans(points, {}, centers, KMeansOptions{5});
+    EXPECT_EQ(centers.back(), far);
+    EXPECT_TRUE(r.converged);
+}
+
+TEST(KMeans, MiniBatch) {
+    std::mt19937 rng(2137);
+    const auto points = test::make_profiles(20000, 20, 1000, 0, rng);
+    const std::vector<Profile> init(points.begin(), points.begin() + 20);
+
+    KMeansOptions options{20};
+    options.batch = 256;
+    options.seed = 5;
+    auto one = init, many = init, lloyd = init;
+    options.threads = 1;
+    const KMeansResult r1 = kmeans(points, {}, one, options);
+    options.threads = 4;
+    const KMeansResult r4 = kmeans(points, {}, many, options);
+    EXPECT_EQ(one, many);
+    EXPECT_EQ(r1.assignment, r4.assignment);
+    EXPECT_EQ(r1.iterations, 20);
+
+    // 20 batches of 256 see a quarter of the points, and get close to Lloyd
+    const KMeansResult full = kmeans(points, {}, lloyd, KMeansOptions{20});
+    EXPECT_LT(r1.error, 1.05 * full.error);
+}
+
+TEST(KMeans, KernelMatchesDouble) {
+    std::mt19937 rng(2137);
+    const auto points = test::make_profiles(50, 5, 1000, 0, rng);
+    const std::vector<Profile> centers(points.begin() + 10, points.begin() + 47); // not a whole block
+    const ProfileRows rows(points);
+    const CenterBlocks blocks(centers);
+
+    std::vector<float> out(centers.size());
+    for (int i = 0; i < static_cast<int>(points.size()); i++) {
+        l1_distances(rows.row(i), blocks, out.data());
+        int expect = -1;
+        double expect_best = 1e300;
+        for (std::size_t c = 0; c < centers.size(); c++) {
+            const double d = l1_distance(points[i], centers[c]);
+            EXPECT_NEAR(out[c], d, 1e-6 * d + 1e-3);
+            if (d < expect_best) expect_best = d, expect = static_cast<int>(c);
+        }
+        float best, second;
+        EXPECT_EQ(nearest_center(rows.row(i), blocks, best, second), expect);
+        EXPECT_NEAR(best, expect_best, 1e-6 * expect_best + 1e-3);
+    }
+}
@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
+#include <cstdio>
 #include <string>
+#include <vector>
 #include <iostream>
 
 #include "logic/probability_table.hpp"
+#include "logic/superset_count.hpp"
 using namespace thai_poker;
 
 TEST(ProbabilityTableTest, BuildSaveLoad) {
@@ -34,4 +37,209 @@ TEST(ProbabilityTableTest, Comp) {
         prob_table.get_comp(Bet::FLUSH_C, 3, Hand{0}),
         0
     );
-}
\ No newline at end of file
+}
+
+TEST(ProbabilityTableTest, AnalyticMatchesSos) {
+    ProbabilityTable& prob_table = ProbabilityTable::instance();
+    HandTable& hand_table = HandTable::instance();
+
+    // one bet of every kind, rebuilt with SOS since the instance may come
+    // from either builder
+    const Bet bets[] = {Bet::HIGH_T, Bet::PAIR_Q, Bet::LOW_STRAIGHT, Bet::HIGH_STRAIGHT, Bet::THREE_A,
+                        Bet::FULL_9K, Bet::FLUSH_H, Bet::QUADS_J, Bet::POKER_S, Bet::ROYAL_POKER_D};
+    const int card_nbs[] = {0, 1, 4, 6, 9, 12, 17, 24};
+    std::vector<int> slices;
+    for (Bet bet : bets) {
+        for (int card_nb : card_nbs)
+            slices.push_back(to_i(bet) * (CARD_NB + 1) + card_nb);
+    }
+    prob_table.build(0, slices);
+
+    long long mismatches = 0;
+    for (Bet bet : bets) {
+        SupersetCounter counter(bet);
+        for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
+            Hand hand = hand_table.from_index(hand_index);
+            auto const& counts = counter.counts(hand);
+            for (int card_nb : card_nbs) {
+                int sos = prob_table.get_comp(bet, card_nb, hand);
+                if (sos != counts[card_nb] && mismatches++ == 0) {
+                    ADD_FAILURE() << "bet " << to_i(bet) << " card_nb " << card_nb << " hand " << hand
+                                  << ": sos " << sos << " analytic " << counts[card_nb];
+                }
+            }
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+// every slice, run with --gtest_also_run_disabled_tests
+TEST(ProbabilityTableTest, DISABLED_AnalyticMatchesSosExhaustive) {
+    ProbabilityTable& prob_table = ProbabilityTable::instance();
+    HandTable& hand_table = HandTable::instance();
+
+    prob_table.build();
+
+    long long mismatches = 0;
+    for (int bet = 0; bet < BET_NB; bet++) {
+        SupersetCounter counter(static_cast<Bet>(bet));
+        for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
+            Hand hand = hand_table.from_index(hand_index);
+            auto const& counts = counter.counts(hand);
+            for (int card_nb = 0; card_nb <= CARD_NB; card_nb++) {
+                int sos = prob_table.get_comp(static_cast<Bet>(bet), card_nb, hand);
+                if (sos != counts[card_nb] && mismatches++ == 0) {
+                    ADD_FAILURE() << "bet " << bet << " card_nb " << card_nb << " hand " << hand
+                                  << ": sos " << sos << " analytic " << counts[card_nb];
+                }
+            }
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+
+TEST(ProbabilityTableTest, MmapMatchesRead) {
+    ProbabilityTable& prob_table = ProbabilityTable::instance();
+    HandTable& hand_table = HandTable::instance();
+
+    // a copy of its own, TTP0.bin stays as it is
+    const std::string table_filename = std::string(DATA_DIR) + "/TTP0_test.bin";
+    prob_table.save(table_filename);
+
+    ProbabilityTable::Options options;
+    options.load_mode = ProbabilityTable::LoadMode::Mmap;
+    options.access = MappedFile::Access::Sequential;
+    ProbabilityTable mapped(table_filename, options);
+
+    for (int bet = 0; bet < BET_NB; bet++) {
+        for (int card_nb = 0; card_nb <= CARD_NB; card_nb++) {
+            for (int hand_index = 0; hand_index < HAND_NB; hand_index += 97) {
+                Hand hand = hand_table.from_index(hand_index);
+                ASSERT_EQ(mapped.get_comp(static_cast<Bet>(bet), card_nb, hand),
+                          prob_table.get_comp(static_cast<Bet>(bet), card_nb, hand));
+            }
+        }
+    }
+    std::remove(table_filename.c_str());
+}
+
+
+TEST(ProbabilityTableTest, BuildDoesNotDependOnThreads) {
+    ProbabilityTable& prob_table = ProbabilityTable::instance();
+    HandTable& hand_table = HandTable::instance();
+
+    // a few slices of every kind of bet, more than one per worker
+    std::vector<int> slices;
+    for (Bet bet : {Bet::HIGH_9, Bet::PAIR_K, Bet::LOW_STRAIGHT, Bet::HIGH_STRAIGHT, Bet::THREE_Q, Bet::FULL_AK,
+                    Bet::FLUSH_S, Bet::QUADS_T, Bet::POKER_D, Bet::ROYAL_POKER_C}) {
+        for (int card_nb : {0, 5, 6, 11})
+            slices.push_back(to_i(bet) * (CARD_NB + 1) + card_nb);
+    }
+    auto snapshot = [&] {
+        std::vector<int> comps;
+        for (int slice : slices) {
+            for (int hand_index = 0; hand_index < HAND_NB; hand_index++) {
+                comps.push_back(prob_table.get_comp(static_cast<Bet>(slice / (CARD_NB + 1)), slice % (CARD_NB + 1),
+                                                    hand_table.from_index(hand_index)));
+            }
+        }
+        return comps;
+    };
+
+    const std::vector<int> before = snapshot();
+    prob_table.build(1, slices);
+    const std::vector<int> serial = snapshot();
+    prob_table.build(4, slices);
+    EXPECT_TRUE(snapshot() == serial);
+    EXPECT_TRUE(serial == before);
+}
+
+
+TEST(ProbabilityTableTest, HandMajorVector) {
+    ProbabilityTable& prob_table = ProbabilityTable::instance();
+    HandTable& hand_table = HandTable::instance();
+
+    ProbabilityTable::Options options;
+    options.layout = ProbabilityTable::Layout::HandMajor;
+    ProbabilityTable hand_major(std::string(DATA_DIR) + "/TTP0.bin", options);
+
+    std::array<int, BET_NB> comp;
+    std::array<float, BET_NB> prob;
+    for (int hand_index = 0; hand_index < HAND_NB; hand_index += 31) {
+        Hand hand = hand_table.from_index(hand_index);
+        for (int card_nb = popcount(hand); card_nb <= CARD_NB; card_nb++) {
+            hand_major.get_comp_vector(card_nb, hand, comp);
+            hand_major.get_prob_vector(card_nb, hand, prob);
+            for (int bet = 0; bet < BET_NB; bet++) {
+                ASSERT_EQ(comp[bet], prob_table.get_comp(static_cast<Bet>(bet), card_nb, hand));
+                ASSERT_FLOAT_EQ(prob[bet], static_cast<float>(prob_table.get_prob(static_cast<Bet>(bet), card_nb, hand)));
+            }
+        }
+    }
+}
+
+
+TEST(ProbabilityTableTest, Quantized) {
+    ProbabilityTable& prob_table = ProbabilityTable::instance();
+    HandTable& hand_table = HandTable::instance();
+
+    for (int bits : {8, 16}) {
+        QuantizedTable quant = QuantizedTable::from(prob_table, bits);
+        EXPECT_LE(quant.max_error(), 0.5 / ((1 << bits) - 1));
+        EXPECT_LE(quant.memory_bytes(), sizeof(int) * BET_NB * (CARD_NB+1) * HAND_NB * bits / 32 + 65536);
+
+        double worst = 0;
+        for (int hand_index = 0; hand_index < HAND_NB; hand_index += 7) {
+            Hand hand = hand_table.from_index(hand_index);
+            for (int bet = 0; bet < BET_NB; bet++) {
+                for (int card_nb = popcount(hand); card_nb <= CARD_NB; card_nb++) {
+                    double exact = prob_table.get_prob(static_cast<Bet>(bet), card_nb, hand);
+                    worst = std::max(worst, std::abs(exact - quant.get_prob(static_cast<Bet>(bet), card_nb, hand_index)));
+                }
+            }
+        }
+        EXPECT_LE(worst, quant.max_error() + 1e-12) << "bits = " << bits;
+
+        if (bits == 16) {
+            const std::string path = std::string(DATA_DIR) + "/TTQ0_test.bin";
+            quant.save(path);
+
+            ProbabilityTable::Options options;
+            options.load_mode = ProbabilityTable::LoadMode::Quantized;
+            ProbabilityTable served(path, options);
+            Hand hand = hand_table.from_index(12345);
+            for (int bet = 0; bet < BET_NB; bet++) {
+                EXPECT_EQ(served.get_prob(static_cast<Bet>(bet), 12, hand),
+                          quant.get_prob(static_cast<Bet>(bet), 12, 12345));
+            }
+            EXPECT_THROW((void) served.get_comp(Bet::PAIR_A, 12, hand), std::logic_error);
+            std::remove(path.c_str());
+        }
+    }
+}
+
+
+TEST(ProbabilityTableTest, LazySlices) {
+    ProbabilityTable& prob_table = ProbabilityTable::instance();
+    HandTable& hand_table = HandTable::instance();
+
+    const std::string path = std::string(DATA_DIR) + "/TTS0_test.bin";
+    std::remove(path.c_str());
+
+    ProbabilityTable::Options options;
+    options.load_mode = ProbabilityTable::LoadMode::Lazy;
+
+    const Bet bets[] = {Bet::PAIR_9, Bet::LOW_STRAIGHT, Bet::FULL_QK, Bet::POKER_H};
+    for (int pass = 0; pass < 2; pass++) {
+        // the first pass computes and persists, the second reads the file back
+        ProbabilityTable lazy(path, options);
+        for (Bet bet : bets) {
+            for (int hand_index = 0; hand_index < HAND_NB; hand_index += 11) {
+                Hand hand = hand_table.from_index(hand_index);
+                ASSERT_EQ(lazy.get_comp(bet, 14, hand), prob_table.get_comp(bet, 14, hand));
+            }
+        }
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+#include <bit>
+#include <random>
+#include <vector>
+
+#include "logic/subset_sum.hpp"
+using namespace thai_poker;
+
+TEST(SubsetSum, MatchesNaive) {
+    std::mt19937 rng(2137);
+    // below, at and above the in-cache block size, and bit counts that
+    // are not a multiple of the three bits done per sweep
+    for (int bits : {0, 1, 2, 5, 12, 13, 14, 16}) {
+        std::vector<int> a(1U << bits);
+        for (int& x : a)
+            x = static_cast<int>(rng() % 3);
+        std::vector<int> b = a;
+
+        superset_sum(a.data(), bits);
+        superset_sum_naive(b.data(), bits);
+        EXPECT_EQ(a, b) << "bits = " << bits;
+    }
+}
+
+TEST(SubsetSum, CountsSupersets) {
+    const int bits = 10;
+    std::vector<int> a(1U << bits, 1);
+    superset_sum(a.data(), bits);
+    for (unsigned mask = 0; mask < (1U << bits); mask++)
+        EXPECT_EQ(a[mask], 1 << (bits - std::popcount(mask)));
+}
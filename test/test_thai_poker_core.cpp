@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "core/thai_poker.hpp"
+#include <vector>
 using namespace thai_poker;
 
 TEST(ThaiPoker, EnumShape) {
@@ -105,4 +106,34 @@ TEST(ThaiPoker, SatisfiesBet) {
             Bet::THREE_9
         )
     );
-}
\ No newline at end of file
+}
+
+TEST(ThaiPoker, SatisfiedBetsMatchesSingle) {
+    for (Hand deck = 0; deck < (1U << CARD_NB); deck += 97) {
+        BetSet set = satisfied_bets(deck);
+        for (int bet = 0; bet < BET_NB; bet++)
+            ASSERT_EQ(set.test(static_cast<Bet>(bet)), satisfies_bet(deck, static_cast<Bet>(bet)))
+                << "deck " << deck << " bet " << bet;
+        ASSERT_FALSE(set.test(Bet::CHECK));
+    }
+}
+
+TEST(ThaiPoker, SatisfiedBetsBatched) {
+    std::vector<Hand> decks;
+    for (Hand deck = 0; deck < (1U << CARD_NB); deck += 1031)
+        decks.push_back(deck);
+    std::vector<BetSet> sets(decks.size());
+    satisfied_bets(decks, sets);
+    for (size_t i = 0; i < decks.size(); i++)
+        ASSERT_EQ(sets[i], satisfied_bets(decks[i]));
+}
+
+TEST(ThaiPoker, BestBetMatchesScan) {
+    EXPECT_EQ(best_bet(0), Bet::CHECK);
+    for (Hand deck = 1; deck < (1U << CARD_NB); deck += 61) {
+        int expected = BET_NB - 1;
+        while (!satisfies_bet(deck, static_cast<Bet>(expected)))
+            expected--;
+        ASSERT_EQ(best_bet(deck), static_cast<Bet>(expected)) << "deck " << deck;
+    }
+}